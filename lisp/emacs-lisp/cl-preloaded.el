@@ -392,6 +392,7 @@ symbol
 
 (cl--define-built-in-type obarray atom)
 (cl--define-built-in-type native-comp-unit atom)
+(cl--define-built-in-type json-document atom)
 
 (cl--define-built-in-type sequence t "Abstract supertype of sequences.")
 (cl--define-built-in-type list sequence)
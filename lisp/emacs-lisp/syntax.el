@@ -544,6 +544,7 @@ syntax-ppss-flush-cache
   (unless (syntax-propertize--in-process-p)
     (setq syntax-propertize--done (min beg syntax-propertize--done)))
   ;; Flush invalid cache entries.
+  (syntax-ppss--flush beg)
   (dolist (cell (list syntax-ppss-wide syntax-ppss-narrow))
     (pcase cell
       (`(,last . ,cache)
@@ -651,6 +652,13 @@ syntax-ppss
                    (<= pt-min pos) (< (- pos pt-min) syntax-ppss-max-span))
               (syntax-ppss--update-stats 1 pt-min pos)
               (setq ppss (parse-partial-sexp pt-min pos)))
+             ;; In a widened buffer, the C code keeps a cache of its own.
+             ((and (eq (point-min) 1) (null syntax-begin-function))
+              ;; Setup the before-change function if necessary.
+              (unless (or ppss-cache ppss-last)
+                (add-hook 'before-change-functions
+                          #'syntax-ppss-flush-cache 99 t))
+              (setq ppss (syntax-ppss--parse pos)))
              ;; The OLD-* data can't be used.  Consult the cache.
              (t
               (let ((cache-pred nil)
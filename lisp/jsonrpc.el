@@ -4,7 +4,7 @@
 
 ;; Author: João Távora <joaotavora@gmail.com>
 ;; Keywords: processes, languages, extensions
-;; Version: 1.0.25
+;; Version: 1.0.26
 ;; Package-Requires: ((emacs "25.2"))
 
 ;; This is a GNU ELPA :core package.  Avoid functionality that is not
@@ -546,7 +546,11 @@ initialize-instance
       (process-put proc 'jsonrpc-stderr stderr-buffer))
     (setf (jsonrpc--process conn) proc)
     (set-process-buffer proc (get-buffer-create (format " *%s output*" name)))
-    (set-process-filter proc #'jsonrpc--process-filter)
+    (if (fboundp 'set-process-json-rpc-framing)
+        (progn
+          (set-process-filter proc #'jsonrpc--process-message-filter)
+          (jsonrpc--set-framing proc conn))
+      (set-process-filter proc #'jsonrpc--process-filter))
     (set-process-sentinel proc #'jsonrpc--process-sentinel)
     (set-process-coding-system proc 'binary 'binary)
     (with-current-buffer (process-buffer proc)
@@ -580,11 +584,18 @@ jsonrpc-connection-send
                      (id 'request)
                      (method 'notification)))
          (converted (jsonrpc-convert-to-endpoint connection args kind))
-         (json (jsonrpc--json-encode converted)))
-    (process-send-string
-     (jsonrpc--process connection)
-     (concat "Content-Length: " (number-to-string (string-bytes json)) "\r\n"
-              "\r\n" json))
+         (json nil))
+    (if (fboundp 'json-send-to-process)
+        (setq json (json-send-to-process (jsonrpc--process connection)
+                                         converted
+                                         (jsonrpc--framing connection)
+                                         :false-object :json-false
+                                         :null-object nil))
+      (setq json (jsonrpc--json-encode converted))
+      (process-send-string
+       (jsonrpc--process connection)
+       (concat "Content-Length: " (number-to-string (string-bytes json)) "\r\n"
+               "\r\n" json)))
     (jsonrpc--event
      connection
      'client
@@ -805,25 +816,74 @@ jsonrpc--process-filter
           ;; to `jsonrpc-connection-receive' below (bug#60088).
           ;;
           (setf (jsonrpc--expected-bytes conn) expected-bytes)
-          ;; Now, time to notify user code of one or more messages in
-          ;; order.  Very often `jsonrpc-connection-receive' will exit
-          ;; non-locally (typically the reply to a request), so do
-          ;; this all this processing in top-level loops timer.
-          (cl-loop
-           ;; `timer-activate' orders timers by time, which is an
-           ;; very expensive operation when jsonrpc-mqueue is large,
-           ;; therefore the time object is reused for each timer
-           ;; created.
-           with time = (current-time)
-           for msg = (pop (process-get proc 'jsonrpc-mqueue)) while msg
-           do (let ((timer (timer-create)))
-                (timer-set-time timer time)
-                (timer-set-function timer
-                                    (lambda (conn msg)
-                                      (with-temp-buffer
-                                        (jsonrpc-connection-receive conn msg)))
-                                    (list conn msg))
-                (timer-activate timer))))))))
+          (jsonrpc--dispatch-messages proc conn))))))
+
+(defvar jsonrpc-event-hook)
+
+(defun jsonrpc--framing (conn)
+  "Return the JSON-RPC framing for the process of CONN.
+This is `text' if the events buffer shows the text of messages or
+other functions in `jsonrpc-event-hook' may use it, and t otherwise."
+  (let* ((props (slot-value conn '-events-buffer-config))
+         (max (plist-get props :size)))
+    (if (or (and (eq (plist-get props :format) 'full)
+                 (or (null max) (cl-plusp max)))
+            (remq #'jsonrpc--log-event jsonrpc-event-hook))
+        'text
+      t)))
+
+(defun jsonrpc--set-framing (proc conn)
+  "Make Emacs split the output of PROC, the process of CONN, into messages."
+  (let ((flag (jsonrpc--framing conn)))
+    (unless (eq flag (process-get proc 'jsonrpc-framing))
+      (process-put proc 'jsonrpc-framing flag)
+      (set-process-json-rpc-framing proc flag
+                                    :object-type 'plist
+                                    :null-object nil
+                                    :false-object :json-false))))
+
+(defun jsonrpc--process-message-filter (proc messages &optional error)
+  "Called when PROC has sent MESSAGES.
+MESSAGES is a list of messages, or of conses (MESSAGE . TEXT).  If
+ERROR is non-nil, MESSAGES is instead the text of a message that is
+not valid JSON, and ERROR says why.  Used instead of
+`jsonrpc--process-filter' when Emacs splits the output of PROC into
+messages and parses them itself; see `set-process-json-rpc-framing'."
+  (let ((conn (process-get proc 'jsonrpc-connection)))
+    (if error
+        (jsonrpc--warn "Invalid JSON: %s %s" (cdr error) messages)
+      ;; Put new messages at the front of the queue, this is correct
+      ;; as the order is reversed before putting the timers on
+      ;; `timer-list'.
+      (dolist (message messages)
+        (push (if (stringp (cdr-safe message))
+                  (plist-put (car message) :jsonrpc-json (cdr message))
+                message)
+              (process-get proc 'jsonrpc-mqueue)))
+      (jsonrpc--dispatch-messages proc conn))
+    ;; Follow changes to the events buffer configuration.
+    (jsonrpc--set-framing proc conn)))
+
+(defun jsonrpc--dispatch-messages (proc conn)
+  "Notify user code of the messages queued for PROC of CONN."
+  ;; Very often `jsonrpc-connection-receive' will exit non-locally
+  ;; (typically the reply to a request), so do this all this
+  ;; processing in top-level loops timer.
+  (cl-loop
+   ;; `timer-activate' orders timers by time, which is an
+   ;; very expensive operation when jsonrpc-mqueue is large,
+   ;; therefore the time object is reused for each timer
+   ;; created.
+   with time = (current-time)
+   for msg = (pop (process-get proc 'jsonrpc-mqueue)) while msg
+   do (let ((timer (timer-create)))
+        (timer-set-time timer time)
+        (timer-set-function timer
+                            (lambda (conn msg)
+                              (with-temp-buffer
+                                (jsonrpc-connection-receive conn msg)))
+                            (list conn msg))
+        (timer-activate timer))))
 
 (defun jsonrpc--remove (conn id &optional deferred-spec)
   "Cancel CONN's continuations for ID, including its timer, if it exists.
@@ -1069,7 +1129,13 @@ jsonrpc--log-event
                                            (if id (format "[%s]" id) "")))))
                (msg
                 (pcase format
-                  ('full  (format "%s%s\n" preamble (or json log-text)))
+                  ('full  (format "%s%s\n" preamble
+                                  (or json log-text
+                                      ;; Connections that don't keep
+                                      ;; the JSON text.
+                                      (and foreign-message
+                                           (jsonrpc--json-encode
+                                            foreign-message)))))
                   ('short (format "%s%s\n" preamble (or log-text "")))
                   (_
                    (format "%s%s" preamble
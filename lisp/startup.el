@@ -1138,6 +1138,115 @@ startup--load-user-init-file
 (defvar lisp-directory nil
   "Directory where Emacs's own *.el and *.elc Lisp files are installed.")
 
+(defvar startup--session-dump nil
+  "Information about the session dump Emacs started from, or nil.
+This is non-nil only in a dump made by `dump-emacs-session'.  The value
+looks like (TIME . FILES), where TIME is when the dump was made and
+FILES is a list of (FILE . MTIME) for the files whose contents went
+into the session.  MTIME is the modification time of FILE as returned
+by `file-attribute-modification-time', or nil if FILE did not exist.")
+
+(defun startup--session-files ()
+  "Return the files whose contents went into this session.
+The value is a list of (FILE . MTIME), as in `startup--session-dump'.
+Files in `lisp-directory' belong to the Emacs installation, so they are
+left out."
+  (let ((lisp-dir (and lisp-directory
+                       (file-name-as-directory
+                        (expand-file-name lisp-directory))))
+        (files nil))
+    ;; Record the init files even if they don't exist, since creating
+    ;; one changes the session too.
+    (dolist (file (list early-init-file user-init-file custom-file
+                        (bound-and-true-p package-user-dir)
+                        (bound-and-true-p package-quickstart-file)))
+      (when (stringp file)
+        (setq file (expand-file-name file))
+        (unless (assoc file files)
+          (push (cons file (file-attribute-modification-time
+                            (file-attributes file)))
+                files))))
+    (dolist (elt load-history)
+      (let ((file (car elt)))
+        (when (and (stringp file)
+                   (file-name-absolute-p file)
+                   (not (and lisp-dir (string-prefix-p lisp-dir file)))
+                   (not (assoc file files)))
+          (let ((attrs (file-attributes file)))
+            (when attrs
+              (push (cons file (file-attribute-modification-time attrs))
+                    files))))))
+    (nreverse files)))
+
+(defun startup--session-dump-stale-files ()
+  "Return the files that changed since the session dump was made."
+  (let ((stale nil))
+    (pcase-dolist (`(,file . ,mtime) (cdr startup--session-dump))
+      (let ((attrs (file-attributes file)))
+        (unless (if mtime
+                    (and attrs
+                         (time-equal-p mtime
+                                       (file-attribute-modification-time
+                                        attrs)))
+                  (null attrs))
+          (push file stale))))
+    (nreverse stale)))
+
+(defun startup--check-session-dump ()
+  "Warn if files changed since the session dump was made."
+  (let ((stale (startup--session-dump-stale-files)))
+    (when stale
+      (display-warning
+       'initialization
+       (format-message "\
+These files changed since the session dump was made:\n\n%s\n\n\
+Run `dump-emacs-session' again to update the dump."
+                       (mapconcat (lambda (file) (concat "  " file))
+                                  stale "\n"))
+       :warning))))
+
+(defun dump-emacs-session (filename)
+  "Dump the state of this session, with its init files loaded, to FILENAME.
+Starting Emacs with \"--dump-file FILENAME\" then restores that state
+instead of loading the init files and activating the packages again.
+At startup, Emacs checks whether any of the files that went into the
+session changed since, and if so, displays a warning.
+
+This works only in batch mode, after Emacs has loaded the init files,
+for instance with
+
+  emacs --batch --user \"\" --eval \\='(dump-emacs-session \"FILE\")\\='
+
+The session must not have live processes, other threads or frames
+other than the initial one.  If objects that would not work in a new
+session, such as processes, can still be reached from other objects,
+this signals an error and reports where they are referenced from on
+the standard error stream.  Emacs should exit after calling this."
+  (unless (fboundp 'dump-emacs-portable)
+    (error "This Emacs cannot make portable dumps"))
+  (let ((problems nil))
+    (dolist (process (process-list))
+      (push (format "process `%s'" (process-name process)) problems))
+    (when (and (fboundp 'all-threads) (cdr (all-threads)))
+      (push "other threads" problems))
+    (when (cdr (frame-list))
+      (push "other frames" problems))
+    (when problems
+      (error "Cannot dump a session with %s"
+             (mapconcat #'identity (nreverse problems) ", "))))
+  (setq filename (expand-file-name filename))
+  (let ((startup--session-dump (cons (current-time)
+                                     (startup--session-files))))
+    (condition-case err
+        (dump-emacs-portable filename nil t)
+      (error
+       ;; Dump again, this time keeping track of where the offending
+       ;; objects came from, so as to report it.
+       (ignore-errors (dump-emacs-portable filename t t))
+       (when (file-exists-p filename)
+         (delete-file filename))
+       (signal (car err) (cdr err))))))
+
 (defvar load-path-filter--cache nil
   "A cache used by `load-path-filter-cache-directory-files'.
 
@@ -1431,23 +1540,26 @@ command-line
   ;; be loaded from `site-run-file' and wants to test if -q was given
   ;; should check `init-file-user' instead, since that is already set.
   ;; See cus-edit.el for an example.
-  (when site-run-file
+  (when (and site-run-file (not startup--session-dump))
     ;; Sites should not disable the startup screen.
     ;; Only individuals may disable the startup screen.
     (let ((inhibit-startup-screen inhibit-startup-screen))
       (load site-run-file t t)))
 
-  ;; Load the early init file, if found.
-  (startup--load-user-init-file
-   (lambda ()
-     (expand-file-name
-      ;; We use an explicit .el extension here to force
-      ;; startup--load-user-init-file to set user-init-file to "early-init.el",
-      ;; with the .el extension, if the file doesn't exist, not just
-      ;; "early-init" without an extension, as it does for ".emacs".
-      "early-init.el"
-      startup-init-directory)))
-  (setq early-init-file user-init-file)
+  ;; Load the early init file, if found.  A session dump has loaded
+  ;; the init files already.
+  (if startup--session-dump
+      (startup--check-session-dump)
+    (startup--load-user-init-file
+     (lambda ()
+       (expand-file-name
+        ;; We use an explicit .el extension here to force
+        ;; startup--load-user-init-file to set user-init-file to "early-init.el",
+        ;; with the .el extension, if the file doesn't exist, not just
+        ;; "early-init" without an extension, as it does for ".emacs".
+        "early-init.el"
+        startup-init-directory)))
+    (setq early-init-file user-init-file))
 
   ;; Amend `native-comp-eln-load-path', since the early-init file may
   ;; have altered `user-emacs-directory' and/or changed the eln-cache
@@ -1549,32 +1661,33 @@ command-line
 	(old-face-ignored-fonts face-ignored-fonts))
 
     ;; Load the user's init file, or the default one, or none.
-    (startup--load-user-init-file
-     (lambda ()
-       (cond
-	((eq startup-init-directory xdg-dir) nil)
-        ((eq system-type 'ms-dos)
-         (concat "~" init-file-user "/_emacs"))
-        ((not (eq system-type 'windows-nt))
-         (concat "~" init-file-user "/.emacs"))
-        ;; Else deal with the Windows situation.
-        ((directory-files "~" nil "\\`\\.emacs\\(\\.elc?\\)?\\'")
-         ;; Prefer .emacs on Windows.
-         "~/.emacs")
-        ((directory-files "~" nil "\\`_emacs\\(\\.elc?\\)?\\'")
-         ;; Also support _emacs for compatibility, but warn about it.
-         (push `(initialization
-                 ,(format-message
-                   "`_emacs' init file is deprecated, please use `.emacs'"))
-               delayed-warnings-list)
-         "~/_emacs")
-        (t ;; But default to .emacs if _emacs does not exist.
-         "~/.emacs")))
-     (lambda ()
-       (expand-file-name
-        "init.el"
-        startup-init-directory))
-     t)
+    (unless startup--session-dump
+      (startup--load-user-init-file
+       (lambda ()
+         (cond
+	  ((eq startup-init-directory xdg-dir) nil)
+          ((eq system-type 'ms-dos)
+           (concat "~" init-file-user "/_emacs"))
+          ((not (eq system-type 'windows-nt))
+           (concat "~" init-file-user "/.emacs"))
+          ;; Else deal with the Windows situation.
+          ((directory-files "~" nil "\\`\\.emacs\\(\\.elc?\\)?\\'")
+           ;; Prefer .emacs on Windows.
+           "~/.emacs")
+          ((directory-files "~" nil "\\`_emacs\\(\\.elc?\\)?\\'")
+           ;; Also support _emacs for compatibility, but warn about it.
+           (push `(initialization
+                   ,(format-message
+                     "`_emacs' init file is deprecated, please use `.emacs'"))
+                 delayed-warnings-list)
+           "~/_emacs")
+          (t ;; But default to .emacs if _emacs does not exist.
+           "~/.emacs")))
+       (lambda ()
+         (expand-file-name
+          "init.el"
+          startup-init-directory))
+       t))
 
     ;; Amend `native-comp-eln-load-path' again, since the early-init
     ;; file may have altered `user-emacs-directory' and/or changed the
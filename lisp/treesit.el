@@ -116,6 +116,7 @@ treesit-declare-unavailable-functions
      (declare-function treesit-query-expand "treesit.c")
      (declare-function treesit-query-compile "treesit.c")
      (declare-function treesit-query-capture "treesit.c")
+     (declare-function treesit--query-fontify "treesit.c")
 
      (declare-function treesit-search-subtree "treesit.c")
      (declare-function treesit-search-forward "treesit.c")
@@ -1973,38 +1974,40 @@ treesit--font-lock-fontify-region-1
 non-nil, print debugging information."
   (let* ((delta-start (car treesit--font-lock-query-expand-range))
          (delta-end (cdr treesit--font-lock-query-expand-range))
-         (captures (treesit-query-capture
-                    node query
-                    (max (- start delta-start) (point-min))
-                    (min (+ end delta-end) (point-max)))))
-
-    ;; For each captured node, fontify that node.
-    (with-silent-modifications
-      (dolist (capture captures)
-        (let* ((face (car capture))
-               (node (cdr capture))
-               (node-start (treesit-node-start node))
-               (node-end (treesit-node-end node)))
-
-          ;; If node is not in the region, take them out.  See
-          ;; comment #3 above for more detail.
-          (if (and (facep face)
-                   (or (>= start node-end) (>= node-start end)))
-              (when (or loudly treesit--font-lock-verbose)
-                (message "Captured node %s(%s-%s) but it is outside of fontifing region" node node-start node-end))
-
-            (cond
-             ((facep face)
-              (treesit-fontify-with-override
-               (max node-start start) (min node-end end)
-               face override))
-             ((functionp face)
-              (funcall face node override start end)))
-
-            ;; Don't raise an error if FACE is neither a face nor
-            ;; a function.  This is to allow intermediate capture
-            ;; names used for #match and #eq.
-            (when (or loudly treesit--font-lock-verbose)
+         (query-start (max (- start delta-start) (point-min)))
+         (query-end (min (+ end delta-end) (point-max))))
+    (if (not (or loudly treesit--font-lock-verbose))
+        ;; The fast path does the same as the loop below, without
+        ;; making a list of captures.
+        (with-silent-modifications
+          (treesit--query-fontify node query query-start query-end
+                                  start end override))
+      ;; For each captured node, fontify that node.
+      (with-silent-modifications
+        (dolist (capture (treesit-query-capture
+                          node query query-start query-end))
+          (let* ((face (car capture))
+                 (node (cdr capture))
+                 (node-start (treesit-node-start node))
+                 (node-end (treesit-node-end node)))
+
+            ;; If node is not in the region, take them out.  See
+            ;; comment #3 above for more detail.
+            (if (and (facep face)
+                     (or (>= start node-end) (>= node-start end)))
+                (message "Captured node %s(%s-%s) but it is outside of fontifing region" node node-start node-end)
+
+              (cond
+               ((facep face)
+                (treesit-fontify-with-override
+                 (max node-start start) (min node-end end)
+                 face override))
+               ((functionp face)
+                (funcall face node override start end)))
+
+              ;; Don't raise an error if FACE is neither a face nor
+              ;; a function.  This is to allow intermediate capture
+              ;; names used for #match and #eq.
               (message "Fontifying text from %d to %d, Face: %s, Node: %s"
                        (max node-start start) (min node-end end)
                        face (treesit-node-type node)))))))))
@@ -163,6 +163,7 @@ Copyright (C) 1985-2025 Free Software Foundation, Inc.
   struct Lisp_Overlay Lisp_Overlay;
   struct Lisp_Subr Lisp_Subr;
   struct Lisp_Sqlite Lisp_Sqlite;
+  struct Lisp_JSON_Document Lisp_JSON_Document;
   struct Lisp_User_Ptr Lisp_User_Ptr;
   struct terminal terminal;
   struct thread_state thread_state;
@@ -3150,6 +3151,11 @@ cleanup_vector (struct Lisp_Vector *vector)
     case PVEC_TS_COMPILED_QUERY:
 #ifdef HAVE_TREE_SITTER
       treesit_delete_query (PSEUDOVEC_STRUCT (vector, Lisp_TS_Query));
+#endif
+      break;
+    case PVEC_TS_CURSOR:
+#ifdef HAVE_TREE_SITTER
+      treesit_delete_cursor (PSEUDOVEC_STRUCT (vector, Lisp_TS_Cursor));
 #endif
       break;
     case PVEC_MODULE_FUNCTION:
@@ -3209,6 +3215,14 @@ cleanup_vector (struct Lisp_Vector *vector)
 	hash_table_allocated_bytes -= bytes;
       }
       break;
+    case PVEC_JSON_DOCUMENT:
+      {
+	struct Lisp_JSON_Document *d
+	  = PSEUDOVEC_STRUCT (vector, Lisp_JSON_Document);
+	if (NILP (d->parent))
+	  xfree (d->tape);
+      }
+      break;
     /* Keep the switch exhaustive.  */
     case PVEC_NORMAL_VECTOR:
     case PVEC_FREE:
@@ -6255,6 +6269,10 @@ mark_face_cache (struct face_cache *c)
 	      mark_objects (face->lface, LFACE_VECTOR_SIZE);
 	    }
 	}
+
+      if (c->merge_cache)
+	for (int i = 0; i < FACE_MERGE_CACHE_SIZE; i++)
+	  mark_object (c->merge_cache[i].prop);
     }
 }
 
@@ -6936,6 +6954,8 @@ sweep_intervals (void)
   int lim = interval_block_index;
   object_ct num_free = 0, num_used = 0;
 
+  /* The hint may point to an interval about to be freed.  */
+  clear_find_interval_hint ();
   interval_free_list = 0;
 
   for (struct interval_block *iblk; (iblk = *iprev); )
@@ -638,11 +638,13 @@ DEFUN ("get-buffer-create", Fget_buffer_create, Sget_buffer_create, 1, 2, 0,
   *(BUF_GPT_ADDR (b)) = *(BUF_Z_ADDR (b)) = 0; /* Put an anchor '\0'.  */
   b->text->inhibit_shrinking = false;
   b->text->redisplay = false;
+  b->text->ppss_checkpoints_end = BEG;
 
   b->newline_cache = 0;
   b->width_run_cache = 0;
   b->bidi_paragraph_cache = 0;
   bset_width_table (b, Qnil);
+  bset_ppss_checkpoints (b, Qnil);
   b->prevent_redisplay_optimizations_p = 1;
 
 #ifdef HAVE_TREE_SITTER
@@ -877,6 +879,7 @@ DEFUN ("make-indirect-buffer", Fmake_indirect_buffer, Smake_indirect_buffer,
   b->width_run_cache = 0;
   b->bidi_paragraph_cache = 0;
   bset_width_table (b, Qnil);
+  bset_ppss_checkpoints (b, Qnil);
 
 #ifdef HAVE_TREE_SITTER
   /* By default, use empty linecol, which means disable tracking.  */
@@ -2182,6 +2185,7 @@ DEFUN ("kill-buffer", Fkill_buffer, Skill_buffer, 0, 1, "bKill buffer: ",
       b->bidi_paragraph_cache = 0;
     }
   bset_width_table (b, Qnil);
+  bset_ppss_checkpoints (b, Qnil);
   unblock_input ();
 
   run_buffer_list_update_hook (b);
@@ -2624,6 +2628,7 @@ #define swapfield_(field, type) \
   swapfield (newline_cache, struct region_cache *);
   swapfield (width_run_cache, struct region_cache *);
   swapfield (bidi_paragraph_cache, struct region_cache *);
+  swapfield_ (ppss_checkpoints, Lisp_Object);
   current_buffer->prevent_redisplay_optimizations_p = 1;
   other_buffer->prevent_redisplay_optimizations_p = 1;
   swapfield (long_line_optimizations_p, bool_bf);
@@ -3145,13 +3150,36 @@ overlays_at (ptrdiff_t pos, bool extend,
 		      false, true, next_ptr);
 }
 
+/* The last result of next_overlay_change, in the overlay tree whose
+   modcount is MODCOUNT, with ZV equal to ZV.  No overlay starts or
+   ends after FROM and before TO, so TO is the next overlay change
+   after any position in [FROM, TO).  Redisplay asks for the next
+   overlay change at each of its stop positions, and this saves
+   searching the tree again when there are no overlays between them.  */
+
+static struct
+{
+  uintmax_t modcount;
+  ptrdiff_t zv, from, to;
+} next_overlay_change_cache;
+
 ptrdiff_t
 next_overlay_change (ptrdiff_t pos)
 {
   ptrdiff_t next = ZV;
+  struct itree_tree *tree = current_buffer->overlays;
   struct itree_node *node;
 
-  ITREE_FOREACH (node, current_buffer->overlays, pos, next, ASCENDING)
+  if (itree_empty_p (tree))
+    return next;
+
+  if (next_overlay_change_cache.modcount == tree->modcount
+      && next_overlay_change_cache.zv == ZV
+      && next_overlay_change_cache.from <= pos
+      && pos < next_overlay_change_cache.to)
+    return next_overlay_change_cache.to;
+
+  ITREE_FOREACH (node, tree, pos, next, ASCENDING)
     {
       if (node->begin > pos)
         {
@@ -3168,6 +3196,14 @@ next_overlay_change (ptrdiff_t pos)
         }
     }
 
+  if (pos < next)
+    {
+      next_overlay_change_cache.modcount = tree->modcount;
+      next_overlay_change_cache.zv = ZV;
+      next_overlay_change_cache.from = pos;
+      next_overlay_change_cache.to = next;
+    }
+
   return next;
 }
 
@@ -4733,6 +4769,7 @@ init_buffer_once (void)
   bset_case_canon_table (&buffer_local_flags, make_fixnum (0));
   bset_case_eqv_table (&buffer_local_flags, make_fixnum (0));
   bset_width_table (&buffer_local_flags, make_fixnum (0));
+  bset_ppss_checkpoints (&buffer_local_flags, make_fixnum (0));
   bset_pt_marker (&buffer_local_flags, make_fixnum (0));
   bset_begv_marker (&buffer_local_flags, make_fixnum (0));
   bset_zv_marker (&buffer_local_flags, make_fixnum (0));
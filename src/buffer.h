@@ -301,6 +301,11 @@ #define FETCH_BYTE(n) (*BYTE_POS_ADDR (n))
 
     /* True if it needs to be redisplayed.  */
     bool_bf redisplay : 1;
+
+    /* No buffer sharing this text has `syntax-ppss' checkpoints
+       beyond this position, so that changes after it need not
+       discard any.  See syntax.c.  */
+    ptrdiff_t ppss_checkpoints_end;
   };
 
 /* Most code should use this macro to access Lisp fields in struct buffer.  */
@@ -486,6 +491,10 @@ #define BVAR(buf, field) ((buf)->field ## _)
      invalidate the width run cache, and re-initialize width_table.  */
   Lisp_Object width_table_;
 
+  /* The `syntax-ppss' checkpoints of this buffer, a vector, or nil if
+     there are none.  See syntax.c.  */
+  Lisp_Object ppss_checkpoints_;
+
   /* In an indirect buffer, or a buffer that is the base of an
      indirect buffer, this holds a marker that records
      PT for this buffer when the buffer is not current.  */
@@ -858,6 +867,11 @@ bset_point_before_scroll (struct buffer *b, Lisp_Object val)
   b->point_before_scroll_ = val;
 }
 INLINE void
+bset_ppss_checkpoints (struct buffer *b, Lisp_Object val)
+{
+  b->ppss_checkpoints_ = val;
+}
+INLINE void
 bset_read_only (struct buffer *b, Lisp_Object val)
 {
   b->read_only_ = val;
@@ -33,6 +33,10 @@
     (1 << CHARTAB_SIZE_BITS_2),
     (1 << CHARTAB_SIZE_BITS_3) };
 
+/* Incremented whenever Lisp code changes a char-table in place, so
+   that values computed from char-tables can be cached.  */
+modiff_count char_table_modiff;
+
 /* Number of characters each element of Nth level char-table
    covers.  */
 static const int chartab_chars[4] =
@@ -540,6 +544,7 @@ DEFUN ("set-char-table-parent", Fset_char_table_parent, Sset_char_table_parent,
     }
 
   set_char_table_parent (char_table, parent);
+  char_table_modiff++;
 
   return parent;
 }
@@ -571,6 +576,7 @@ DEFUN ("set-char-table-extra-slot", Fset_char_table_extra_slot,
     args_out_of_range (char_table, n);
 
   set_char_table_extras (char_table, XFIXNUM (n), value);
+  char_table_modiff++;
   return value;
 }
 
@@ -635,6 +641,7 @@ DEFUN ("set-char-table-range", Fset_char_table_range, Sset_char_table_range,
     }
   else
     error ("Invalid RANGE argument to `set-char-table-range'");
+  char_table_modiff++;
 
   return value;
 }
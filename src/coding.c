@@ -8051,6 +8051,25 @@ decode_coding_gap (struct coding_system *coding, ptrdiff_t bytes)
 }
 
 
+/* Return true if decoding ASCII text by coding context CODING would
+   leave it unchanged, so that it can be inserted into a multibyte
+   buffer as it is.  */
+bool
+coding_decodes_ascii_unchanged (struct coding_system *coding)
+{
+  Lisp_Object attrs = CODING_ID_ATTRS (coding->id);
+
+  return (! disable_ascii_optimization
+	  && ! CODING_REQUIRE_DETECTION (coding)
+	  && (inhibit_eol_conversion
+	      || EQ (CODING_ID_EOL_TYPE (coding->id), Qunix))
+	  && ! NILP (CODING_ATTR_ASCII_COMPAT (attrs))
+	  && NILP (CODING_ATTR_POST_READ (attrs))
+	  && NILP (get_translation_table (attrs, 0, NULL))
+	  && ! (EQ (CODING_ATTR_TYPE (attrs), Qutf_8)
+		&& CODING_UTF_8_BOM (coding) != utf_without_bom));
+}
+
 /* Decode the text in the range FROM/FROM_BYTE and TO/TO_BYTE in
    SRC_OBJECT into DST_OBJECT by coding context CODING.
 
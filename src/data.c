@@ -290,8 +290,12 @@ DEFUN ("cl-type-of", Fcl_type_of, Scl_type_of, 1, 1, 0,
 	  return Qtreesit_node;
 	case PVEC_TS_COMPILED_QUERY:
 	  return Qtreesit_compiled_query;
+	case PVEC_TS_CURSOR:
+	  return Qtreesit_cursor;
         case PVEC_SQLITE:
           return Qsqlite;
+        case PVEC_JSON_DOCUMENT:
+          return Qjson_document;
         case PVEC_SUB_CHAR_TABLE:
           return Qsub_char_table;
         /* "Impossible" cases.  */
@@ -2613,6 +2617,7 @@ DEFUN ("aset", Faset, Saset, 3, 3, 0,
     {
       CHECK_CHARACTER (idx);
       CHAR_TABLE_SET (array, idxval, newelt);
+      char_table_modiff++;
     }
   else if (RECORDP (array))
     {
@@ -4201,6 +4206,7 @@ #define PUT_ERROR(sym, tail, msg)			\
   DEFSYM (Qtreesit_parser, "treesit-parser");
   DEFSYM (Qtreesit_node, "treesit-node");
   DEFSYM (Qtreesit_compiled_query, "treesit-compiled-query");
+  DEFSYM (Qtreesit_cursor, "treesit-cursor");
   DEFSYM (Qobarray, "obarray");
 
   DEFSYM (Qdefun, "defun");
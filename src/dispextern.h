@@ -1946,6 +1946,22 @@ #define FACE_UNIBYTE_P(FACE) ((FACE)->charset < 0)
 
 #define MAX_FACE_ID  ((1 << FACE_ID_BITS) - 1)
 
+/* Size of the merge cache of a face cache.  Must be a power of 2.  */
+
+enum { FACE_MERGE_CACHE_SIZE = 256 };
+
+/* An entry of the merge cache of a face cache: FACE_ID is the realized
+   face resulting from merging the `face' property value PROP into the
+   face BASE_FACE_ID, with attribute filter ATTR_FILTER.  */
+
+struct face_merge_cache_entry
+{
+  Lisp_Object prop;
+  int base_face_id;
+  int attr_filter;
+  int face_id;
+};
+
 /* A cache of realized faces.  Each frame has its own cache because
    Emacs allows different frame-local face definitions.  */
 
@@ -1954,6 +1970,11 @@ #define MAX_FACE_ID  ((1 << FACE_ID_BITS) - 1)
   /* Hash table of cached realized faces.  */
   struct face **buckets;
 
+  /* Cache of faces produced by face_at_buffer_position from `face'
+     text properties, FACE_MERGE_CACHE_SIZE entries or NULL.  Emptied
+     whenever realized faces are freed.  */
+  struct face_merge_cache_entry *merge_cache;
+
   /* Back-pointer to the frame this cache belongs to.  */
   struct frame *f;
 
@@ -1290,23 +1290,13 @@ row_equal_p (struct glyph_row *a, struct glyph_row *b, bool mouse_face_p)
       if (mouse_face_p && a->mouse_face_p != b->mouse_face_p)
 	return 0;
 
-      /* Compare glyphs.  */
+      /* Rows with equal hash codes usually have equal contents, so
+	 reject the cheap mismatches first: different glyph counts in
+	 any area, or different row attributes.  Only then compare the
+	 glyphs themselves, which is by far the most expensive part.  */
       for (area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
-	{
-	  if (a->used[area] != b->used[area])
-	    return 0;
-
-	  a_glyph = a->glyphs[area];
-	  a_end = a_glyph + a->used[area];
-	  b_glyph = b->glyphs[area];
-
-	  while (a_glyph < a_end
-		 && GLYPH_EQUAL_P (a_glyph, b_glyph))
-	    ++a_glyph, ++b_glyph;
-
-	  if (a_glyph != a_end)
-	    return 0;
-	}
+	if (a->used[area] != b->used[area])
+	  return 0;
 
       if (a->fill_line_p != b->fill_line_p
 	  || a->cursor_in_fringe_p != b->cursor_in_fringe_p
@@ -1331,6 +1321,21 @@ row_equal_p (struct glyph_row *a, struct glyph_row *b, bool mouse_face_p)
 	  || a->phys_height != b->phys_height
 	  || a->visible_height != b->visible_height)
 	return 0;
+
+      /* Compare glyphs.  */
+      for (area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+	{
+	  a_glyph = a->glyphs[area];
+	  a_end = a_glyph + a->used[area];
+	  b_glyph = b->glyphs[area];
+
+	  while (a_glyph < a_end
+		 && GLYPH_EQUAL_P (a_glyph, b_glyph))
+	    ++a_glyph, ++b_glyph;
+
+	  if (a_glyph != a_end)
+	    return 0;
+	}
     }
 
   return 1;
@@ -2544,7 +2544,13 @@ font_match_p (Lisp_Object spec, Lisp_Object font)
 
    where DRIVER-TYPE is a symbol such as `x', `xft', etc., NUM-FRAMES
    is a number frames sharing this cache, and FONT-CACHE-DATA is a
-   cons (FONT-SPEC . [FONT-ENTITY ...]).  */
+   cons (FONT-SPEC . [FONT-ENTITY ...]).
+
+   The first FONT-CACHE-DATA can be preceded by a hash table that
+   maps each FONT-SPEC to its FONT-CACHE-DATA, see font_cache_lookup.
+   Since the cache is shared by all frames on a display, and fontsets
+   can put a lot of entries in it, this avoids looking through them all
+   when, for instance, a new frame realizes its faces.  */
 
 static void font_clear_cache (struct frame *, Lisp_Object,
                               struct font_driver const *);
@@ -2607,6 +2613,71 @@ font_get_cache (struct frame *f, struct font_driver const *driver)
 }
 
 
+/* Return the hash table indexing the font cache CACHE, which is as
+   returned by font_get_cache, creating it if needed.  */
+
+static Lisp_Object
+font_cache_index (Lisp_Object cache)
+{
+  Lisp_Object tail = XCDR (cache);
+
+  if (CONSP (tail) && HASH_TABLE_P (XCAR (tail)))
+    return XCAR (tail);
+
+  /* Entries removed from the cache by compact_font_caches during GC
+     must disappear from the index too.  */
+  Lisp_Object index = make_hash_table (&hashtest_equal, DEFAULT_HASH_SIZE,
+				       Weak_Key);
+  struct Lisp_Hash_Table *h = XHASH_TABLE (index);
+
+  for (; CONSP (tail); tail = XCDR (tail))
+    {
+      Lisp_Object elt = XCAR (tail);
+      hash_hash_t hash;
+
+      if (CONSP (elt) && FONT_SPEC_P (XCAR (elt))
+	  && hash_find_get_hash (h, XCAR (elt), &hash) < 0)
+	hash_put (h, XCAR (elt), elt, hash);
+    }
+
+  XSETCDR (cache, Fcons (index, XCDR (cache)));
+  return index;
+}
+
+/* Return the FONT-CACHE-DATA of the font cache CACHE, which is as
+   returned by font_get_cache, for font-spec SPEC, or nil if there is
+   none.  */
+
+static Lisp_Object
+font_cache_lookup (Lisp_Object cache, Lisp_Object spec)
+{
+  struct Lisp_Hash_Table *h = XHASH_TABLE (font_cache_index (cache));
+  ptrdiff_t i = hash_find (h, spec);
+
+  return i < 0 ? Qnil : HASH_VALUE (h, i);
+}
+
+/* Add the FONT-CACHE-DATA for font-spec SPEC, whose value is VAL, to
+   the font cache CACHE, which is as returned by font_get_cache.  SPEC
+   must not be in the cache yet.  */
+
+static void
+font_cache_add (Lisp_Object cache, Lisp_Object spec, Lisp_Object val)
+{
+  Lisp_Object index = font_cache_index (cache);
+  struct Lisp_Hash_Table *h = XHASH_TABLE (index);
+  Lisp_Object elt = Fcons (spec, val);
+  hash_hash_t hash;
+  ptrdiff_t i = hash_find_get_hash (h, spec, &hash);
+
+  eassert (i < 0);
+  hash_put (h, spec, elt, hash);
+
+  /* Keep the index at the front.  */
+  Lisp_Object tail = XCDR (cache);
+  XSETCDR (tail, Fcons (elt, XCDR (tail)));
+}
+
 static void
 font_clear_cache (struct frame *f, Lisp_Object cache,
 		  struct font_driver const *driver)
@@ -2832,7 +2903,7 @@ font_list_entities (struct frame *f, Lisp_Object spec)
 	Lisp_Object cache = font_get_cache (f, driver_list->driver);
 
 	ASET (scratch_font_spec, FONT_TYPE_INDEX, driver_list->driver->type);
-	val = assoc_no_quit (scratch_font_spec, XCDR (cache));
+	val = font_cache_lookup (cache, scratch_font_spec);
 	if (CONSP (val))
 	  val = XCDR (val);
 	else
@@ -2851,7 +2922,7 @@ font_list_entities (struct frame *f, Lisp_Object spec)
 	      val = Fvconcat (1, &val);
 	    copy = copy_font_spec (scratch_font_spec);
 	    ASET (copy, FONT_TYPE_INDEX, driver_list->driver->type);
-	    XSETCDR (cache, Fcons (Fcons (copy, val), XCDR (cache)));
+	    font_cache_add (cache, copy, val);
 	  }
 	if (ASIZE (val) > 0
 	    && (need_filtering
@@ -2901,7 +2972,7 @@ font_matching_entity (struct frame *f, Lisp_Object *attrs, Lisp_Object spec)
 	Lisp_Object cache = font_get_cache (f, driver_list->driver);
 
 	ASET (work, FONT_TYPE_INDEX, driver_list->driver->type);
-	entity = assoc_no_quit (work, XCDR (cache));
+	entity = font_cache_lookup (cache, work);
 	if (CONSP (entity))
 	  entity = AREF (XCDR (entity), 0);
 	else
@@ -2913,7 +2984,7 @@ font_matching_entity (struct frame *f, Lisp_Object *attrs, Lisp_Object spec)
 		Lisp_Object match = Fvector (1, &entity);
 
 		ASET (copy, FONT_TYPE_INDEX, driver_list->driver->type);
-		XSETCDR (cache, Fcons (Fcons (copy, match), XCDR (cache)));
+		font_cache_add (cache, copy, match);
 	      }
 	  }
 	if (! NILP (entity))
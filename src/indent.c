@@ -50,6 +50,54 @@ #define CR 015
 
 static modiff_count last_known_column_modified;
 
+/* Places where scan_for_column stopped, so that a later scan of the
+   same line can resume from there instead of from the beginning of the
+   line.  Each entry is valid only as long as the text, the overlays and
+   the settings that affect the width of the text stay the same.  The
+   Lisp objects are used only as keys, but they are protected from GC
+   so that they cannot be reused for other objects while in the cache.
+   Since char-tables can be changed in place, an entry also records
+   char_table_modiff.  */
+
+struct column_cache_entry
+{
+  /* The buffer, or nil if this entry is unused.  */
+  Lisp_Object buffer;
+
+  /* The window, display table and char-width-table that were used.  */
+  Lisp_Object window, disptab, char_width_table;
+
+  /* A copy of buffer-invisibility-spec, which can be changed in
+     place.  */
+  Lisp_Object invisibility_spec;
+
+  /* MODIFF and OVERLAY_MODIFF of the buffer, and char_table_modiff.  */
+  modiff_count modiff, overlay_modiff, char_table_modiff;
+
+  /* Other settings that affect widths.  The window's text area width
+     and the frame's column width are in pixels, and matter for images
+     and other display specs.  */
+  int tab_width, window_width, column_width;
+  bool_bf ctl_arrow : 1;
+  bool_bf selective : 1;
+
+  /* The beginning of the line.  */
+  ptrdiff_t line_beg;
+
+  /* Where the scan stopped, and the column there.  */
+  ptrdiff_t pos, pos_byte, col;
+
+  /* The position and column of the previous character.  */
+  ptrdiff_t prev_pos, prev_bpos, prev_col;
+};
+
+enum { COLUMN_CACHE_SIZE = 4 };
+
+static struct column_cache_entry column_cache[COLUMN_CACHE_SIZE];
+
+/* The entry to be replaced next.  */
+static int column_cache_next;
+
 static ptrdiff_t current_column_1 (void);
 static ptrdiff_t position_indentation (ptrdiff_t);
 
@@ -596,13 +644,65 @@ check_display_width (Lisp_Object window,
   return -1;
 }
 
+/* Return the pixel widths of the text area of the window W and of the
+   columns of its frame in *WINDOW_WIDTH and *COLUMN_WIDTH, or zeros if
+   W is NULL.  */
+
+static void
+column_cache_widths (struct window *w, int *window_width, int *column_width)
+{
+  *window_width = w ? window_box_width (w, TEXT_AREA) : 0;
+  *column_width = w ? FRAME_COLUMN_WIDTH (XFRAME (w->frame)) : 0;
+}
+
+/* Return the entry of the column cache for the line of the current
+   buffer that begins at LINE_BEG, or NULL if there is none.  WINDOW and
+   DISPTAB are the window and display table used for computing widths.  */
+
+static struct column_cache_entry *
+column_cache_find (ptrdiff_t line_beg, Lisp_Object window,
+		   Lisp_Object disptab)
+{
+  int window_width, column_width;
+
+  column_cache_widths (! NILP (window) ? XWINDOW (window) : NULL,
+		       &window_width, &column_width);
+  for (int i = 0; i < COLUMN_CACHE_SIZE; i++)
+    {
+      struct column_cache_entry *entry = &column_cache[i];
+
+      if (EQ (entry->buffer, Fcurrent_buffer ())
+	  && entry->line_beg == line_beg
+	  && entry->modiff == MODIFF
+	  && entry->overlay_modiff == OVERLAY_MODIFF
+	  && entry->char_table_modiff == char_table_modiff
+	  && EQ (entry->window, window)
+	  && entry->window_width == window_width
+	  && entry->column_width == column_width
+	  && EQ (entry->disptab, disptab)
+	  && EQ (entry->char_width_table, Vchar_width_table)
+	  && !NILP (Fequal (entry->invisibility_spec,
+			    BVAR (current_buffer, invisibility_spec)))
+	  && entry->tab_width == SANE_TAB_WIDTH (current_buffer)
+	  && entry->ctl_arrow == !NILP (BVAR (current_buffer, ctl_arrow))
+	  && entry->selective == EQ (BVAR (current_buffer, selective_display),
+				     Qt))
+	return entry;
+    }
+  return NULL;
+}
+
 /* Scanning from the beginning of the current line, stop at the buffer
    position ENDPOS or at the column GOALCOL or at the end of line, whichever
    comes first.
    Return the resulting buffer position and column in ENDPOS and GOALCOL.
    PREVCOL gets set to the column of the previous position (it's always
    strictly smaller than the goal column), and PREVPOS and PREVBPOS get set
-   to the corresponding buffer character and byte positions.  */
+   to the corresponding buffer character and byte positions.
+
+   If an earlier scan of the same line stopped before ENDPOS and before
+   GOALCOL, resume it instead of starting over, and remember where this
+   scan stops for the next one.  */
 static void
 scan_for_column (ptrdiff_t *endpos, EMACS_INT *goalcol,
 		 ptrdiff_t *prevpos, ptrdiff_t *prevbpos, ptrdiff_t *prevcol)
@@ -612,16 +712,23 @@ scan_for_column (ptrdiff_t *endpos, EMACS_INT *goalcol,
   struct Lisp_Char_Table *dp = buffer_display_table ();
   bool multibyte = !NILP (BVAR (current_buffer, enable_multibyte_characters));
   struct composition_it cmp_it;
-  Lisp_Object window;
+  Lisp_Object window, disptab = Qnil;
   struct window *w;
+  struct column_cache_entry *entry = NULL;
+  bool resumed = false;
+  modiff_count modiff = MODIFF, overlay_modiff = OVERLAY_MODIFF;
 
   /* Start the scan at the beginning of this line with column number 0.  */
   register ptrdiff_t col = 0, prev_col = 0;
   EMACS_INT goal = goalcol ? *goalcol : MOST_POSITIVE_FIXNUM;
   ptrdiff_t end = endpos ? *endpos : PT;
   ptrdiff_t scan, scan_byte, next_boundary, prev_pos, prev_bpos;
+  ptrdiff_t line_beg;
 
   scan = find_newline (PT, PT_BYTE, BEGV, BEGV_BYTE, -1, NULL, &scan_byte, 1);
+  line_beg = scan;
+  if (dp)
+    XSETCHAR_TABLE (disptab, dp);
 
   window = Fget_buffer_window (Fcurrent_buffer (), Qnil);
   w = ! NILP (window) ? XWINDOW (window) : NULL;
@@ -661,6 +768,8 @@ scan_for_column (ptrdiff_t *endpos, EMACS_INT *goalcol,
 	      prev_col = col - 1;
 	      prev_pos = scan - 1;
 	      prev_bpos = CHAR_TO_BYTE (scan);
+	      /* This column is an approximation; don't cache it.  */
+	      line_beg = 0;
 	      goto endloop;
 	    }
 	  /* Restore the values we've overwritten above.  */
@@ -668,13 +777,37 @@ scan_for_column (ptrdiff_t *endpos, EMACS_INT *goalcol,
 	  col = 0;
 	}
     }
-  next_boundary = scan;
   prev_pos = scan;
   prev_bpos = scan_byte;
 
   memset (&cmp_it, 0, sizeof cmp_it);
   cmp_it.id = -1;
-  composition_compute_stop_pos (&cmp_it, scan, scan_byte, end, Qnil, true);
+
+  entry = column_cache_find (line_beg, window, disptab);
+  if (entry && entry->pos <= end && entry->col < goal)
+    {
+      composition_compute_stop_pos (&cmp_it, entry->pos, entry->pos_byte,
+				    end, Qnil, true);
+      /* If a composition could start before the place where the
+	 earlier scan stopped, this scan has to see it.  */
+      if (cmp_it.stop_pos >= entry->pos)
+	{
+	  scan = entry->pos;
+	  scan_byte = entry->pos_byte;
+	  col = entry->col;
+	  prev_pos = entry->prev_pos;
+	  prev_bpos = entry->prev_bpos;
+	  prev_col = entry->prev_col;
+	  resumed = true;
+	}
+    }
+  if (!resumed)
+    {
+      memset (&cmp_it, 0, sizeof cmp_it);
+      cmp_it.id = -1;
+      composition_compute_stop_pos (&cmp_it, scan, scan_byte, end, Qnil, true);
+    }
+  next_boundary = scan;
 
   /* Scan forward to the target position.  */
   while (scan < end)
@@ -832,6 +965,40 @@ scan_for_column (ptrdiff_t *endpos, EMACS_INT *goalcol,
   last_known_column_point = PT;
   last_known_column_modified = MODIFF;
 
+  /* Remember where we stopped, unless we stopped inside a composition
+     or past END, or Lisp code run during the scan changed the buffer.  */
+  Lisp_Object spec = BVAR (current_buffer, invisibility_spec);
+  if (line_beg > 0 && cmp_it.id < 0 && scan <= end
+      && MODIFF == modiff && OVERLAY_MODIFF == overlay_modiff
+      && (!CONSP (spec) || !NILP (Fproper_list_p (spec))))
+    {
+      if (!entry)
+	{
+	  entry = &column_cache[column_cache_next];
+	  column_cache_next = (column_cache_next + 1) % COLUMN_CACHE_SIZE;
+	  /* The elements of the spec are atoms or conses of atoms.  */
+	  entry->invisibility_spec = CONSP (spec) ? Fcopy_alist (spec) : spec;
+	}
+      entry->buffer = Fcurrent_buffer ();
+      entry->window = window;
+      column_cache_widths (w, &entry->window_width, &entry->column_width);
+      entry->disptab = disptab;
+      entry->char_width_table = Vchar_width_table;
+      entry->modiff = modiff;
+      entry->overlay_modiff = overlay_modiff;
+      entry->char_table_modiff = char_table_modiff;
+      entry->tab_width = tab_width;
+      entry->ctl_arrow = ctl_arrow;
+      entry->selective = EQ (BVAR (current_buffer, selective_display), Qt);
+      entry->line_beg = line_beg;
+      entry->pos = scan;
+      entry->pos_byte = scan_byte;
+      entry->col = col;
+      entry->prev_pos = prev_pos;
+      entry->prev_bpos = prev_bpos;
+      entry->prev_col = prev_col;
+    }
+
   if (goalcol)
     *goalcol = col;
   if (endpos)
@@ -2550,6 +2717,16 @@ syms_of_indent (void)
 
   DEFSYM (Qcolumns, "columns");
 
+  for (int i = 0; i < COLUMN_CACHE_SIZE; i++)
+    {
+      column_cache[i].buffer = Qnil;
+      staticpro (&column_cache[i].buffer);
+      staticpro (&column_cache[i].window);
+      staticpro (&column_cache[i].disptab);
+      staticpro (&column_cache[i].char_width_table);
+      staticpro (&column_cache[i].invisibility_spec);
+    }
+
   defsubr (&Scurrent_indentation);
   defsubr (&Sindent_to);
   defsubr (&Scurrent_column);
@@ -2205,6 +2205,8 @@ prepare_to_modify_buffer (ptrdiff_t start, ptrdiff_t end,
 void
 invalidate_buffer_caches (struct buffer *buf, ptrdiff_t start, ptrdiff_t end)
 {
+  syntax_ppss_flush_checkpoints (buf, start);
+
   /* Indirect buffers usually have their caches set to NULL, but we
      need to consider the caches of their base buffer.  */
   if (buf->base_buffer)
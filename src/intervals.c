@@ -55,6 +55,29 @@ #define TMEM(sym, set) (CONSP (set) ? ! NILP (Fmemq (sym, set)) : ! NILP (set))
 static INTERVAL merge_interval_right (INTERVAL);
 static INTERVAL reproduce_tree (INTERVAL, INTERVAL);
 
+/* The interval most recently returned by find_interval for a buffer,
+   used to answer the common case of a lookup at or just after the
+   previous one without descending the tree again.  TREE is the root
+   of the tree the hint belongs to and POSITION the start of INTERVAL.
+   The hint is dropped whenever the shape of any interval tree changes
+   and when intervals are garbage collected.  */
+
+static struct
+{
+  INTERVAL tree;
+  INTERVAL interval;
+  ptrdiff_t position;
+} find_interval_hint;
+
+/* Forget the find_interval hint.  */
+
+void
+clear_find_interval_hint (void)
+{
+  find_interval_hint.tree = NULL;
+  find_interval_hint.interval = NULL;
+}
+
 /* Utility functions for intervals.  */
 
 /* Use these functions to set pointer slots of struct interval.  */
@@ -493,6 +516,7 @@ split_interval_right (INTERVAL interval, ptrdiff_t offset)
   ptrdiff_t position = interval->position;
   ptrdiff_t new_length = LENGTH (interval) - offset;
 
+  clear_find_interval_hint ();
   new->position = position + offset;
   set_interval_parent (new, interval);
 
@@ -536,6 +560,7 @@ split_interval_left (INTERVAL interval, ptrdiff_t offset)
   INTERVAL new = make_interval ();
   ptrdiff_t new_length = offset;
 
+  clear_find_interval_hint ();
   new->position = interval->position;
   interval->position = interval->position + offset;
   set_interval_parent (new, interval);
@@ -601,6 +626,8 @@ find_interval (register INTERVAL tree, register ptrdiff_t position)
   /* The distance from the left edge of the subtree at TREE
                     to POSITION.  */
   register ptrdiff_t relative_position;
+  INTERVAL root;
+  bool buffer_p = false;
 
   if (!tree)
     return NULL;
@@ -611,12 +638,42 @@ find_interval (register INTERVAL tree, register ptrdiff_t position)
       Lisp_Object parent;
       GET_INTERVAL_OBJECT (parent, tree);
       if (BUFFERP (parent))
-	relative_position -= BUF_BEG (XBUFFER (parent));
+	{
+	  relative_position -= BUF_BEG (XBUFFER (parent));
+	  buffer_p = true;
+	}
     }
 
   eassert (relative_position <= TOTAL_LENGTH (tree));
 
+  /* Redisplay and the text property functions tend to look up
+     positions in increasing order, so try the interval found last
+     time and its successor before searching the tree.  */
+  if (buffer_p && find_interval_hint.tree == tree)
+    {
+      INTERVAL i = find_interval_hint.interval;
+      ptrdiff_t start = find_interval_hint.position;
+
+      if (start <= position)
+	{
+	  if (position < start + LENGTH (i))
+	    {
+	      i->position = start;
+	      return i;
+	    }
+	  i->position = start;
+	  i = next_interval (i);
+	  if (i && position < i->position + LENGTH (i))
+	    {
+	      find_interval_hint.interval = i;
+	      find_interval_hint.position = i->position;
+	      return i;
+	    }
+	}
+    }
+
   tree = balance_possible_root_interval (tree);
+  root = tree;
 
   while (1)
     {
@@ -639,6 +696,13 @@ find_interval (register INTERVAL tree, register ptrdiff_t position)
 	    = (position - relative_position /* left edge of *tree.  */
 	       + LEFT_TOTAL_LENGTH (tree)); /* left edge of this interval.  */
 
+	  if (buffer_p)
+	    {
+	      find_interval_hint.tree = root;
+	      find_interval_hint.interval = tree;
+	      find_interval_hint.position = tree->position;
+	    }
+
 	  return tree;
 	}
     }
@@ -1197,6 +1261,7 @@ delete_interval (register INTERVAL i)
 
   eassert (amt <= 0);	/* Only used on zero total-length intervals now.  */
 
+  clear_find_interval_hint ();
   if (ROOT_INTERVAL_P (i))
     {
       Lisp_Object owner;
@@ -1360,6 +1425,7 @@ offset_intervals (struct buffer *buffer, ptrdiff_t start, ptrdiff_t length)
   if (!buffer_intervals (buffer) || length == 0)
     return;
 
+  clear_find_interval_hint ();
   if (length > 0)
     adjust_intervals_for_insertion (buffer_intervals (buffer),
 				    start, length);
@@ -1382,6 +1448,8 @@ merge_interval_right (register INTERVAL i)
   register ptrdiff_t absorb = LENGTH (i);
   register INTERVAL successor;
 
+  clear_find_interval_hint ();
+
   /* Find the succeeding interval.  */
   if (! NULL_RIGHT_CHILD (i))      /* It's below us.  Add absorb
 				      as we descend.  */
@@ -1438,6 +1506,8 @@ merge_interval_left (register INTERVAL i)
   register ptrdiff_t absorb = LENGTH (i);
   register INTERVAL predecessor;
 
+  clear_find_interval_hint ();
+
   /* Find the preceding interval.  */
   if (! NULL_LEFT_CHILD (i))	/* It's below us. Go down,
 				   adding ABSORB as we go.  */
@@ -1571,6 +1641,8 @@ graft_intervals_into_buffer (INTERVAL source, ptrdiff_t position,
   INTERVAL under, over, this;
   ptrdiff_t over_used;
 
+  clear_find_interval_hint ();
+
   /* If the new text has no properties, then with inheritance it
      becomes part of whatever interval it was inserted into.
      To prevent inheritance, we must clear out the properties
@@ -2411,6 +2483,7 @@ set_intervals_multibyte (bool multi_flag)
 {
   INTERVAL i = buffer_intervals (current_buffer);
 
+  clear_find_interval_hint ();
   if (i)
     set_intervals_multibyte_1 (i, multi_flag, BEG, BEG_BYTE, Z, Z_BYTE);
 }
@@ -463,6 +463,21 @@ itree_node_end (struct itree_tree *tree,
   return node->end;
 }
 
+/* The last value given to the MODCOUNT field of a tree.  */
+
+static uintmax_t itree_last_modcount;
+
+/* Record that TREE has changed.  Since every tree gets a fresh
+   MODCOUNT, clients may use it to validate data they derived from
+   the tree, even after the tree has been freed and its memory
+   reused.  */
+
+static void
+itree_modified (struct itree_tree *tree)
+{
+  tree->modcount = ++itree_last_modcount;
+}
+
 /* Allocate an itree_tree.  Free with itree_destroy.  */
 
 struct itree_tree *
@@ -481,6 +496,7 @@ itree_clear (struct itree_tree *tree)
   tree->root = NULL;
   tree->otick = 1;
   tree->size = 0;
+  itree_modified (tree);
 }
 
 #ifdef ITREE_TESTING
@@ -686,6 +702,7 @@ itree_insert_node (struct itree_tree *tree, struct itree_node *node)
   /* It's the responsibility of the caller to set 'otick' on the node,
      to "confirm" that the begin/end fields are up to date.  */
   eassert (node->otick == otick);
+  itree_modified (tree);
 
   /* Find the insertion point, accumulate node's offset and update
      ancestors limit values.  */
@@ -755,6 +772,7 @@ itree_node_set_region (struct itree_tree *tree,
     }
   else if (end != node->end)
     {
+      itree_modified (tree);
       node->end = max (node->begin, end);
       eassert (node != NULL);
       itree_propagate_limit (node);
@@ -963,6 +981,7 @@ itree_remove (struct itree_tree *tree, struct itree_node *node)
 {
   eassert (itree_contains (tree, node));
   eassert (check_tree (tree, true)); /* FIXME: Too expensive.  */
+  itree_modified (tree);
 
   /* Find 'splice', the leaf node to splice out of the tree.  When
      'node' has at most one child this is 'node' itself.  Otherwise,
@@ -1048,6 +1067,7 @@ itree_insert_gap (struct itree_tree *tree,
 {
   if (!tree || length <= 0 || tree->root == NULL)
     return;
+  itree_modified (tree);
   uintmax_t ootick = tree->otick;
 
   /* FIXME: Don't allocate iterator/stack anew every time. */
@@ -1141,6 +1161,7 @@ itree_delete_gap (struct itree_tree *tree,
 {
   if (!tree || length <= 0 || tree->root == NULL)
     return;
+  itree_modified (tree);
 
   /* FIXME: Don't allocate stack anew every time.  */
 
@@ -99,6 +99,8 @@ #define ITREE_H
   struct itree_node *root;
   uintmax_t otick;              /* offset tick, compared with node's otick. */
   intmax_t size;                /* Number of nodes in the tree. */
+  uintmax_t modcount;		/* Changed whenever the tree changes;
+				   unique among all trees.  */
 };
 
 enum itree_order
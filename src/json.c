@@ -318,29 +318,55 @@ string_not_unicode (Lisp_Object obj)
   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* e0-ff */
 };
 
+/* Return the first byte in [P, END) that is not json_plain_char, or
+   END if there is none.  This tests a word of input at a time: a byte
+   needs a closer look if it is a control character, '"', '\\', or has
+   its high bit set.  */
+static const unsigned char *
+json_skip_plain_chars (const unsigned char *p, const unsigned char *end)
+{
+  enum { W = sizeof (size_t) };
+  size_t const ones = SIZE_MAX / 0xff;
+  size_t const highs = ones * 0x80;
+
+  while (end - p >= W)
+    {
+      size_t w;
+      memcpy (&w, p, W);
+      size_t quote = w ^ (ones * '"');
+      size_t backslash = w ^ (ones * '\\');
+      size_t control = (w - ones * 0x20) & ~w;
+      quote = (quote - ones) & ~quote;
+      backslash = (backslash - ones) & ~backslash;
+      if ((control | quote | backslash | w) & highs)
+	break;
+      p += W;
+    }
+  while (p < end && json_plain_char[*p])
+    p++;
+  return p;
+}
+
+/* Add the text in [P, END) to the buffer, escaped for a JSON string.
+   MULTIBYTE says whether the text is multibyte; STR is the string or
+   buffer that the text comes from, for error messages.  */
 static void
-json_out_string (json_out_t *jo, Lisp_Object str, int skip)
+json_out_text (json_out_t *jo, const unsigned char *p,
+	       const unsigned char *end, bool multibyte, Lisp_Object str)
 {
-  /* FIXME: this code is slow, make faster! */
-
   static const char hexchar[16] ATTRIBUTE_NONSTRING = "0123456789ABCDEF";
-  ptrdiff_t len = SBYTES (str);
-  json_make_room (jo, len + 2);
-  json_out_byte (jo, '"');
-  unsigned char *p = SDATA (str);
-  unsigned char *end = p + len;
-  p += skip;
   while (p < end)
     {
       unsigned char c = *p;
       if (json_plain_char[c])
 	{
-	  json_out_byte (jo, c);
-	  p++;
+	  const unsigned char *plain_end = json_skip_plain_chars (p, end);
+	  json_out_str (jo, (const char *) p, plain_end - p);
+	  p = plain_end;
 	}
       else if (c > 0x7f)
 	{
-	  if (STRING_MULTIBYTE (str))
+	  if (multibyte)
 	    {
 	      int n;
 	      if (c <= 0xc1)
@@ -397,6 +423,36 @@ json_out_string (json_out_t *jo, Lisp_Object str, int skip)
 	  p++;
 	}
     }
+}
+
+static void
+json_out_string (json_out_t *jo, Lisp_Object str, int skip)
+{
+  json_make_room (jo, SBYTES (str) + 2);
+  json_out_byte (jo, '"');
+  json_out_text (jo, SDATA (str) + skip, SDATA (str) + SBYTES (str),
+		 STRING_MULTIBYTE (str), str);
+  json_out_byte (jo, '"');
+}
+
+/* Add the accessible portion of BUFFER as a JSON string.  The text is
+   read from both sides of the gap, without making a Lisp string.  */
+static void
+json_out_buffer (json_out_t *jo, Lisp_Object buffer)
+{
+  struct buffer *b = XBUFFER (buffer);
+  if (!BUFFER_LIVE_P (b))
+    wrong_type_argument (Qjson_value_p, buffer);
+  bool multibyte = !NILP (BVAR (b, enable_multibyte_characters));
+  ptrdiff_t begv = BUF_BEGV_BYTE (b), zv = BUF_ZV_BYTE (b);
+  ptrdiff_t gpt = clip_to_bounds (begv, BUF_GPT_BYTE (b), zv);
+
+  json_make_room (jo, zv - begv + 2);
+  json_out_byte (jo, '"');
+  const unsigned char *p = BUF_BYTE_ADDRESS (b, begv);
+  json_out_text (jo, p, p + (gpt - begv), multibyte, buffer);
+  p = BUF_BYTE_ADDRESS (b, gpt);
+  json_out_text (jo, p, p + (zv - gpt), multibyte, buffer);
   json_out_byte (jo, '"');
 }
 
@@ -555,13 +611,17 @@ json_out_something (json_out_t *jo, Lisp_Object obj)
     json_out_array (jo, obj);
   else if (BIGNUMP (obj))
     json_out_bignum (jo, obj);
+  else if (BUFFERP (obj))
+    json_out_buffer (jo, obj);
   else
     wrong_type_argument (Qjson_value_p, obj);
 }
 
+/* Serialize OBJECT into JO, leaving HEADROOM unused bytes at the
+   start of its buffer.  */
 static void
 json_serialize (json_out_t *jo, Lisp_Object object,
-		ptrdiff_t nargs, Lisp_Object *args)
+		ptrdiff_t nargs, Lisp_Object *args, ptrdiff_t headroom)
 {
   jo->maxdepth = 50;
   jo->size = 0;
@@ -581,9 +641,31 @@ json_serialize (json_out_t *jo, Lisp_Object object,
   if (!NILP (Vfloat_output_format))
     specbind (Qfloat_output_format, Qnil);
 
+  json_make_room (jo, headroom);
+  jo->size = headroom;
   json_out_something (jo, object);
 }
 
+/* Serialize OBJECT as `json-serialize' does with the NARGS keyword
+   arguments in ARGS, and return the output in a buffer that the
+   caller must free with xfree.  Leave HEADROOM unused bytes before
+   the output, and set *NBYTES to the size of the output without
+   them.  */
+
+char *
+json_serialize_bytes (Lisp_Object object, ptrdiff_t nargs, Lisp_Object *args,
+		      ptrdiff_t headroom, ptrdiff_t *nbytes)
+{
+  specpdl_ref count = SPECPDL_INDEX ();
+  json_out_t jo;
+  json_serialize (&jo, object, nargs, args, headroom);
+  char *buf = jo.buf;
+  *nbytes = jo.size - headroom;
+  jo.buf = NULL;
+  unbind_to (count, Qnil);
+  return buf;
+}
+
 DEFUN ("json-serialize", Fjson_serialize, Sjson_serialize, 1, MANY,
        NULL,
        doc: /* Return the JSON representation of OBJECT as a unibyte string.
@@ -598,6 +680,8 @@ DEFUN ("json-serialize", Fjson_serialize, Sjson_serialize, 1, MANY,
 alist      -- a JSON object.  Keys must be symbols.
 plist      -- a JSON object.  Keys must be symbols.
               A leading colon in plist key names is elided.
+buffer     -- a JSON string with the text of the accessible portion
+              of the buffer, without making a Lisp string for it.
 
 For duplicate object keys, the first value is used.
 
@@ -618,7 +702,7 @@ DEFUN ("json-serialize", Fjson_serialize, Sjson_serialize, 1, MANY,
 {
   specpdl_ref count = SPECPDL_INDEX ();
   json_out_t jo;
-  json_serialize (&jo, args[0], nargs - 1, args + 1);
+  json_serialize (&jo, args[0], nargs - 1, args + 1, 0);
   return unbind_to (count, make_unibyte_string (jo.buf, jo.size));
 }
 
@@ -635,7 +719,7 @@ DEFUN ("json-insert", Fjson_insert, Sjson_insert, 1, MANY,
 {
   specpdl_ref count = SPECPDL_INDEX ();
   json_out_t jo;
-  json_serialize (&jo, args[0], nargs - 1, args + 1);
+  json_serialize (&jo, args[0], nargs - 1, args + 1, 0);
 
   prepare_to_modify_buffer (PT, PT, NULL);
   move_gap_both (PT, PT_BYTE);
@@ -897,6 +981,22 @@ json_byte_workspace_put (struct json_parser *parser,
     }
 }
 
+/* Appends the NBYTES bytes at BYTES to the byte_workspace */
+static void
+json_byte_workspace_put_bytes (struct json_parser *parser,
+			       const unsigned char *bytes, ptrdiff_t nbytes)
+{
+  while (parser->byte_workspace_end - parser->byte_workspace_current
+	 < nbytes)
+    {
+      /* Let the slow path grow the workspace, then undo its byte.  */
+      json_byte_workspace_put_slow_path (parser, 0);
+      parser->byte_workspace_current--;
+    }
+  memcpy (parser->byte_workspace_current, bytes, nbytes);
+  parser->byte_workspace_current += nbytes;
+}
+
 static bool
 json_input_at_eof (struct json_parser *parser)
 {
@@ -972,6 +1072,15 @@ is_json_whitespace (int c)
 static int
 json_skip_whitespace (struct json_parser *parser)
 {
+  /* Most of the time the next byte is significant, or the whitespace
+     run is in the current input segment; scan that without going
+     through json_input_get for each byte.  */
+  const unsigned char *p = parser->input_current;
+  const unsigned char *end = parser->input_end;
+  while (p < end && is_json_whitespace (*p))
+    p++;
+  parser->input_current = p;
+
   for (;;)
     {
       int c = json_input_get (parser);
@@ -1029,60 +1138,53 @@ utf8_error (struct json_parser *parser)
   json_signal_error (parser, Qjson_utf8_decode_error);
 }
 
-/* Parse a string literal.  Optionally prepend a ':'.
-   Return the string or an interned symbol.  */
-static Lisp_Object
-json_parse_string (struct json_parser *parser, bool intern, bool leading_colon)
+/* Parse a string literal.  Optionally prepend a ':'.  Set *STR and
+   *NBYTES to the UTF-8 text of the string, which is either in the
+   input or in the byte workspace, and return its number of
+   characters.  */
+static ptrdiff_t
+json_parse_string_bytes (struct json_parser *parser, bool leading_colon,
+			 const char **str, ptrdiff_t *nbytes)
 {
+  const unsigned char *start = parser->input_current;
+  const unsigned char *plain_end
+    = json_skip_plain_chars (start, parser->input_end);
+
+  /* Fast path: a string with only plain ASCII characters, which ends
+     in the current input segment, needs neither decoding nor the byte
+     workspace.  */
+  if (!leading_colon && plain_end < parser->input_end && *plain_end == '"')
+    {
+      *str = (const char *) start;
+      *nbytes = plain_end - start;
+      parser->input_current = plain_end + 1;
+      return *nbytes;
+    }
+
   json_byte_workspace_reset (parser);
   if (leading_colon)
     json_byte_workspace_put (parser, ':');
   ptrdiff_t chars_delta = 0;	/* nbytes - nchars */
   for (;;)
     {
-      /* This if is only here for a possible speedup.  If there are 4
-	 bytes available, and all of them are single_uninteresting,
-	 then we can just copy these 4 bytes to output */
-      if (parser->input_end - parser->input_current >= 4)
+      /* Copy a run of plain characters to the workspace at once.  */
+      if (plain_end > parser->input_current)
 	{
-	  int c0 = parser->input_current[0];
-	  int c1 = parser->input_current[1];
-	  int c2 = parser->input_current[2];
-	  int c3 = parser->input_current[3];
-	  bool v0 = json_plain_char[c0];
-	  bool v1 = json_plain_char[c1];
-	  bool v2 = json_plain_char[c2];
-	  bool v3 = json_plain_char[c3];
-	  if (v0 && v1 && v2 && v3)
-	    {
-	      json_byte_workspace_put (parser, c0);
-	      json_byte_workspace_put (parser, c1);
-	      json_byte_workspace_put (parser, c2);
-	      json_byte_workspace_put (parser, c3);
-	      parser->input_current += 4;
-	      continue;
-	    }
+	  json_byte_workspace_put_bytes (parser, parser->input_current,
+					 plain_end - parser->input_current);
+	  parser->input_current = plain_end;
 	}
 
       int c = json_input_get (parser);
       if (json_plain_char[c])
+	json_byte_workspace_put (parser, c);
+      else if (c == '"')
 	{
-	  json_byte_workspace_put (parser, c);
-	  continue;
+	  *str = (const char *) parser->byte_workspace;
+	  *nbytes = parser->byte_workspace_current - parser->byte_workspace;
+	  return *nbytes - chars_delta;
 	}
-
-      if (c == '"')
-	{
-	  ptrdiff_t nbytes
-	    = parser->byte_workspace_current - parser->byte_workspace;
-	  ptrdiff_t nchars = nbytes - chars_delta;
-	  const char *str = (const char *) parser->byte_workspace;
-	  return (intern
-		  ? intern_c_multibyte (str, nchars, nbytes)
-		  : make_multibyte_string (str, nchars, nbytes));
-	}
-
-      if (c & 0x80)
+      else if (c & 0x80)
 	{
 	  /* Parse UTF-8, strictly.  This is the correct thing to do
 	     whether the input is a unibyte or multibyte string.  */
@@ -1206,9 +1308,26 @@ json_parse_string (struct json_parser *parser, bool intern, bool leading_colon)
 	}
       else
 	json_signal_error (parser, Qjson_parse_error);
+
+      plain_end = json_skip_plain_chars (parser->input_current,
+					 parser->input_end);
     }
 }
 
+/* Parse a string literal.  Optionally prepend a ':'.
+   Return the string or an interned symbol.  */
+static Lisp_Object
+json_parse_string (struct json_parser *parser, bool intern, bool leading_colon)
+{
+  const char *str;
+  ptrdiff_t nbytes;
+  ptrdiff_t nchars = json_parse_string_bytes (parser, leading_colon,
+					      &str, &nbytes);
+  return (intern
+	  ? intern_c_multibyte (str, nchars, nbytes)
+	  : make_multibyte_string (str, nchars, nbytes));
+}
+
 /* If there was no integer overflow during parsing the integer, this
    puts 'value' to the output. Otherwise this calls string_to_number
    to parse integer on the byte workspace.  This could just always
@@ -1688,6 +1807,58 @@ string_byte_to_line (Lisp_Object obj, ptrdiff_t byte)
   return count_newlines (SDATA (obj), byte);
 }
 
+static ptrdiff_t
+bytes_byte_to_pos (Lisp_Object obj, ptrdiff_t byte)
+{
+  return byte;
+}
+
+static ptrdiff_t
+bytes_byte_to_line (Lisp_Object obj, ptrdiff_t byte)
+{
+  return count_newlines (xmint_pointer (obj), byte);
+}
+
+/* Signal an error unless ARGS, a vector, holds valid keyword
+   arguments for json_parse_bytes.  */
+
+void
+json_check_parse_args (Lisp_Object args)
+{
+  struct json_configuration conf
+    = { json_object_hashtable, json_array_array, QCnull, QCfalse };
+  json_parse_args (ASIZE (args), XVECTOR (args)->contents, &conf, true);
+}
+
+/* Parse the JSON value in the NBYTES bytes at BEGIN, which must not
+   move while parsing.  ARGS is a vector of keyword arguments as for
+   `json-parse-string'.  Used for the messages of processes with
+   JSON-RPC framing, which are parsed straight from the process
+   output.  */
+
+Lisp_Object
+json_parse_bytes (const unsigned char *begin, ptrdiff_t nbytes,
+		  Lisp_Object args)
+{
+  specpdl_ref count = SPECPDL_INDEX ();
+
+  struct json_configuration conf
+    = { json_object_hashtable, json_array_array, QCnull, QCfalse };
+  json_parse_args (ASIZE (args), XVECTOR (args)->contents, &conf, true);
+
+  struct json_parser p;
+  json_parser_init (&p, conf, begin, begin + nbytes, NULL, NULL,
+		    bytes_byte_to_pos, bytes_byte_to_line,
+		    make_mint_ptr ((void *) begin));
+  record_unwind_protect_ptr (json_parser_done, &p);
+  Lisp_Object result = json_parse (&p);
+
+  if (json_skip_whitespace_if_possible (&p) >= 0)
+    json_signal_error (&p, Qjson_trailing_content);
+
+  return unbind_to (count, result);
+}
+
 DEFUN ("json-parse-string", Fjson_parse_string, Sjson_parse_string, 1, MANY,
        NULL,
        doc: /* Parse the JSON STRING into a Lisp value.
@@ -1825,6 +1996,530 @@ DEFUN ("json-parse-buffer", Fjson_parse_buffer, Sjson_parse_buffer,
   return unbind_to (count, result);
 }
 
+/* JSON documents.  A document keeps the text of a JSON value and
+   makes Lisp objects only from the parts that are asked for.  Parsing
+   the document validates the whole text and records the arrays and
+   objects of it on a tape; the accessors use the tape to skip over
+   arrays and objects without looking at their contents again.  */
+
+struct json_tape_entry
+{
+  /* The byte offset of the end of the array or object.  */
+  ptrdiff_t end;
+  /* The index of the first entry after those of the array or object
+     and its members.  */
+  ptrdiff_t next;
+  /* The number of elements of the array or members of the object.  */
+  ptrdiff_t count;
+};
+
+struct json_tape
+{
+  struct json_tape_entry *entries;
+  ptrdiff_t size;
+  ptrdiff_t alloc;
+};
+
+static void
+json_tape_free (void *tape)
+{
+  xfree (((struct json_tape *) tape)->entries);
+}
+
+static void json_scan_value (struct json_parser *parser,
+			     struct json_tape *tape, int c);
+
+/* Validates the array or object whose opening bracket was just read,
+   and records it and the arrays and objects in it on TAPE.  CLOSE is
+   the closing bracket.  */
+static void
+json_scan_container (struct json_parser *parser, struct json_tape *tape,
+		     int close)
+{
+  if (tape->size == tape->alloc)
+    tape->entries = xpalloc (tape->entries, &tape->alloc, 1, -1,
+			     sizeof *tape->entries);
+  ptrdiff_t i = tape->size++;
+  ptrdiff_t count = 0;
+
+  int c = json_skip_whitespace (parser);
+  if (c != close)
+    {
+      parser->available_depth--;
+      if (parser->available_depth < 0)
+	json_signal_error (parser, Qjson_object_too_deep);
+
+      for (;;)
+	{
+	  if (close == '}')
+	    {
+	      if (c != '"')
+		json_signal_error (parser, Qjson_parse_error);
+	      const char *str;
+	      ptrdiff_t nbytes;
+	      json_parse_string_bytes (parser, false, &str, &nbytes);
+	      if (json_skip_whitespace (parser) != ':')
+		json_signal_error (parser, Qjson_parse_error);
+	      c = json_skip_whitespace (parser);
+	    }
+	  json_scan_value (parser, tape, c);
+	  count++;
+
+	  c = json_skip_whitespace (parser);
+	  if (c == close)
+	    {
+	      parser->available_depth++;
+	      break;
+	    }
+	  if (c != ',')
+	    json_signal_error (parser, Qjson_parse_error);
+	  c = json_skip_whitespace (parser);
+	}
+    }
+
+  struct json_tape_entry *e = &tape->entries[i];
+  e->end = parser->input_current - parser->input_begin;
+  e->next = tape->size;
+  e->count = count;
+}
+
+/* Validates the JSON value that starts with C, like json_parse_value,
+   but without making Lisp objects for strings and containers.  */
+static void
+json_scan_value (struct json_parser *parser, struct json_tape *tape, int c)
+{
+  switch (c)
+    {
+    case '{':
+      json_scan_container (parser, tape, '}');
+      break;
+    case '[':
+      json_scan_container (parser, tape, ']');
+      break;
+    case '"':
+      {
+	const char *str;
+	ptrdiff_t nbytes;
+	json_parse_string_bytes (parser, false, &str, &nbytes);
+      }
+      break;
+    default:
+      json_parse_value (parser, c);
+      break;
+    }
+}
+
+/* A value in a JSON document: the byte offset POS of the value in the
+   text, and the index TAPE of the first array or object that starts
+   at or after POS.  */
+struct json_document_position
+{
+  ptrdiff_t pos;
+  ptrdiff_t tape;
+};
+
+static ptrdiff_t
+json_document_skip_whitespace (const unsigned char *text, ptrdiff_t pos)
+{
+  while (is_json_whitespace (text[pos]))
+    pos++;
+  return pos;
+}
+
+/* Moves P past the value at P, and past the whitespace after it.  */
+static void
+json_document_skip_value (struct Lisp_JSON_Document *doc,
+			  struct json_document_position *p)
+{
+  const unsigned char *text = SDATA (doc->text);
+  const unsigned char *end = text + SBYTES (doc->text);
+  const unsigned char *q = text + p->pos;
+  switch (*q)
+    {
+    case '{': case '[':
+      q = text + doc->tape[p->tape].end;
+      p->tape = doc->tape[p->tape].next;
+      break;
+    case '"':
+      /* The document is valid, so the string ends at the first '"'
+	 that is not escaped.  */
+      for (q++; ; q++)
+	{
+	  q = json_skip_plain_chars (q, end);
+	  if (*q == '"')
+	    break;
+	  if (*q == '\\')
+	    q++;
+	}
+      q++;
+      break;
+    default:
+      while (q < end && !is_json_whitespace (*q)
+	     && *q != ',' && *q != ']' && *q != '}')
+	q++;
+      break;
+    }
+  p->pos = json_document_skip_whitespace (text, q - text);
+}
+
+/* Moves P from the array or object at P to its first element or
+   member.  */
+static void
+json_document_enter (struct Lisp_JSON_Document *doc,
+		     struct json_document_position *p)
+{
+  p->pos = json_document_skip_whitespace (SDATA (doc->text), p->pos + 1);
+  p->tape++;
+}
+
+/* Moves P from the key of an object member to its value.  */
+static void
+json_document_skip_key (struct Lisp_JSON_Document *doc,
+			struct json_document_position *p)
+{
+  json_document_skip_value (doc, p);
+  /* Skip the ':'.  */
+  p->pos = json_document_skip_whitespace (SDATA (doc->text), p->pos + 1);
+}
+
+/* Moves P from the value of an array element or object member to the
+   next element or member.  */
+static void
+json_document_next (struct Lisp_JSON_Document *doc,
+		    struct json_document_position *p)
+{
+  json_document_skip_value (doc, p);
+  /* Skip the ','.  */
+  p->pos = json_document_skip_whitespace (SDATA (doc->text), p->pos + 1);
+}
+
+static void
+json_document_parser_init (struct json_parser *parser,
+			   struct Lisp_JSON_Document *doc)
+{
+  struct json_configuration conf
+    = { doc->object_type, doc->array_type,
+	doc->null_object, doc->false_object };
+  const unsigned char *begin = SDATA (doc->text);
+  json_parser_init (parser, conf, begin, begin + SBYTES (doc->text),
+		    NULL, NULL, string_byte_to_pos, string_byte_to_line,
+		    doc->text);
+}
+
+/* Returns the Lisp object for the value at POS in DOC.  */
+static Lisp_Object
+json_document_value (struct json_parser *parser,
+		     struct Lisp_JSON_Document *doc, ptrdiff_t pos)
+{
+  parser->input_current = SDATA (doc->text) + pos;
+  return json_parse (parser);
+}
+
+/* Returns whether the key of the object member at POS in DOC is
+   KEY.  */
+static bool
+json_document_key_equal (struct json_parser *parser,
+			 struct Lisp_JSON_Document *doc, ptrdiff_t pos,
+			 Lisp_Object key)
+{
+  Lisp_Object name = SYMBOLP (key) ? SYMBOL_NAME (key) : key;
+  const unsigned char *key_bytes = SDATA (name);
+  ptrdiff_t key_nbytes = SBYTES (name);
+  /* A keyword stands for the key without its colon, as in the plists
+     made for objects.  */
+  if (SYMBOLP (key) && !NILP (Fkeywordp (key)))
+    key_bytes++, key_nbytes--;
+  /* The key of a member is valid UTF-8, so it can be equal to KEY
+     only if KEY is multibyte or ASCII.  */
+  if (!STRING_MULTIBYTE (name) && !string_ascii_p (name))
+    return false;
+
+  parser->input_current = SDATA (doc->text) + pos + 1;
+  const char *str;
+  ptrdiff_t nbytes;
+  json_parse_string_bytes (parser, false, &str, &nbytes);
+  return nbytes == key_nbytes && memcmp (str, key_bytes, nbytes) == 0;
+}
+
+/* Moves P from the value of DOC to the value at PATH, which has NARGS
+   elements.  Returns false if there is no such value.  */
+static bool
+json_document_lookup (struct json_parser *parser,
+		      struct Lisp_JSON_Document *doc,
+		      ptrdiff_t nargs, Lisp_Object *path,
+		      struct json_document_position *p)
+{
+  p->pos = doc->root;
+  p->tape = doc->root_tape;
+  for (ptrdiff_t i = 0; i < nargs; i++)
+    {
+      Lisp_Object elt = path[i];
+      int c = SREF (doc->text, p->pos);
+      if (FIXNUMP (elt))
+	{
+	  if (c != '['
+	      || XFIXNUM (elt) < 0
+	      || XFIXNUM (elt) >= doc->tape[p->tape].count)
+	    return false;
+	  EMACS_INT n = XFIXNUM (elt);
+	  json_document_enter (doc, p);
+	  for (EMACS_INT j = 0; j < n; j++)
+	    json_document_next (doc, p);
+	}
+      else
+	{
+	  if (!SYMBOLP (elt))
+	    CHECK_STRING (elt);
+	  if (c != '{')
+	    return false;
+	  ptrdiff_t count = doc->tape[p->tape].count;
+	  bool found = false;
+	  struct json_document_position value = { 0, 0 };
+	  json_document_enter (doc, p);
+	  for (ptrdiff_t j = 0; j < count; j++)
+	    {
+	      bool match = json_document_key_equal (parser, doc, p->pos, elt);
+	      json_document_skip_key (doc, p);
+	      if (match)
+		{
+		  found = true;
+		  value = *p;
+		  /* Hash tables keep the last of several members with
+		     the same key, alists and plists the first.  */
+		  if (doc->object_type != json_object_hashtable)
+		    break;
+		}
+	      if (j + 1 < count)
+		json_document_next (doc, p);
+	    }
+	  if (!found)
+	    return false;
+	  *p = value;
+	}
+    }
+  return true;
+}
+
+static Lisp_Object
+make_json_document (struct Lisp_JSON_Document *doc,
+		    struct json_document_position *p)
+{
+  struct Lisp_JSON_Document *sub
+    = ALLOCATE_PSEUDOVECTOR (struct Lisp_JSON_Document, parent,
+			     PVEC_JSON_DOCUMENT);
+  sub->text = doc->text;
+  sub->null_object = doc->null_object;
+  sub->false_object = doc->false_object;
+  XSETPSEUDOVECTOR (sub->parent, doc, PVEC_JSON_DOCUMENT);
+  if (!NILP (doc->parent))
+    sub->parent = doc->parent;
+  sub->object_type = doc->object_type;
+  sub->array_type = doc->array_type;
+  sub->root = p->pos;
+  sub->root_tape = p->tape;
+  sub->tape = doc->tape;
+  Lisp_Object obj;
+  XSETPSEUDOVECTOR (obj, sub, PVEC_JSON_DOCUMENT);
+  return obj;
+}
+
+DEFUN ("json-parse-document", Fjson_parse_document, Sjson_parse_document,
+       1, MANY, NULL,
+       doc: /* Parse the JSON STRING into a JSON document.
+A JSON document is like the Lisp value that `json-parse-string' would
+return for STRING, but makes Lisp objects only for the values that are
+asked for with `json-document-get', `json-document-at',
+`json-document-length' and `json-document-elements'.  This can save a
+lot of time and memory when only a small part of a large JSON text is
+needed.
+
+STRING is parsed and validated in full, so this function signals the
+same errors as `json-parse-string'.  The arguments ARGS are also as
+for `json-parse-string', and say how to represent the values of the
+document as Lisp objects.
+usage: (json-parse-document STRING &rest ARGS) */)
+  (ptrdiff_t nargs, Lisp_Object *args)
+{
+  specpdl_ref count = SPECPDL_INDEX ();
+
+  Lisp_Object string = args[0];
+  CHECK_STRING (string);
+  struct json_configuration conf
+    = { json_object_hashtable, json_array_array, QCnull, QCfalse };
+  json_parse_args (nargs - 1, args + 1, &conf, true);
+
+  struct json_parser p;
+  const unsigned char *begin = SDATA (string);
+  json_parser_init (&p, conf, begin, begin + SBYTES (string), NULL, NULL,
+		    string_byte_to_pos, string_byte_to_line, string);
+  record_unwind_protect_ptr (json_parser_done, &p);
+  struct json_tape tape = { NULL, 0, 0 };
+  record_unwind_protect_ptr (json_tape_free, &tape);
+
+  int c = json_skip_whitespace (&p);
+  ptrdiff_t root = p.input_current - 1 - p.input_begin;
+  json_scan_value (&p, &tape, c);
+  if (json_skip_whitespace_if_possible (&p) >= 0)
+    json_signal_error (&p, Qjson_trailing_content);
+
+  struct Lisp_JSON_Document *doc
+    = ALLOCATE_PSEUDOVECTOR (struct Lisp_JSON_Document, parent,
+			     PVEC_JSON_DOCUMENT);
+  doc->text = make_unibyte_string ((const char *) begin, SBYTES (string));
+  doc->null_object = conf.null_object;
+  doc->false_object = conf.false_object;
+  doc->parent = Qnil;
+  doc->object_type = conf.object_type;
+  doc->array_type = conf.array_type;
+  doc->root = root;
+  doc->root_tape = 0;
+  doc->tape = tape.entries;
+  tape.entries = NULL;
+
+  Lisp_Object result;
+  XSETPSEUDOVECTOR (result, doc, PVEC_JSON_DOCUMENT);
+  return unbind_to (count, result);
+}
+
+DEFUN ("json-document-p", Fjson_document_p, Sjson_document_p, 1, 1, 0,
+       doc: /* Return t if OBJECT is a JSON document.  */)
+  (Lisp_Object object)
+{
+  return JSON_DOCUMENTP (object) ? Qt : Qnil;
+}
+
+DEFUN ("json-document-get", Fjson_document_get, Sjson_document_get,
+       1, MANY, 0,
+       doc: /* Return the Lisp value at PATH in the JSON document DOC.
+Each element of PATH selects a value in the previous one: an integer
+selects an element of an array by its index, and a string or symbol
+selects the member of an object with that key.  A keyword selects the
+member whose key is the name of the keyword without its colon.
+If there is more than one member with the key, select the one that a
+JSON object of the document's `:object-type' would have.
+
+With no PATH, return the value of the whole document.  The value is
+represented as `json-parse-string' would represent it with the
+arguments that DOC was parsed with.  If there is no value at PATH,
+return nil.
+usage: (json-document-get DOC &rest PATH)  */)
+  (ptrdiff_t nargs, Lisp_Object *args)
+{
+  specpdl_ref count = SPECPDL_INDEX ();
+  CHECK_JSON_DOCUMENT (args[0]);
+  struct Lisp_JSON_Document *doc = XJSON_DOCUMENT (args[0]);
+
+  struct json_parser parser;
+  json_document_parser_init (&parser, doc);
+  record_unwind_protect_ptr (json_parser_done, &parser);
+  struct json_document_position p;
+  Lisp_Object result = Qnil;
+  if (json_document_lookup (&parser, doc, nargs - 1, args + 1, &p))
+    result = json_document_value (&parser, doc, p.pos);
+  return unbind_to (count, result);
+}
+
+DEFUN ("json-document-at", Fjson_document_at, Sjson_document_at,
+       1, MANY, 0,
+       doc: /* Return the JSON document for the value at PATH in DOC.
+PATH is as for `json-document-get'.  If there is no value at PATH,
+return nil.  The new document shares the text of DOC.
+usage: (json-document-at DOC &rest PATH)  */)
+  (ptrdiff_t nargs, Lisp_Object *args)
+{
+  specpdl_ref count = SPECPDL_INDEX ();
+  CHECK_JSON_DOCUMENT (args[0]);
+  struct Lisp_JSON_Document *doc = XJSON_DOCUMENT (args[0]);
+
+  struct json_parser parser;
+  json_document_parser_init (&parser, doc);
+  record_unwind_protect_ptr (json_parser_done, &parser);
+  struct json_document_position p;
+  Lisp_Object result = Qnil;
+  if (json_document_lookup (&parser, doc, nargs - 1, args + 1, &p))
+    result = make_json_document (doc, &p);
+  return unbind_to (count, result);
+}
+
+DEFUN ("json-document-length", Fjson_document_length,
+       Sjson_document_length, 1, MANY, 0,
+       doc: /* Return the number of elements of the array at PATH in DOC.
+If the value at PATH is an object, return its number of members.
+PATH is as for `json-document-get'.  If the value at PATH is neither
+an array nor an object, or there is no value at PATH, return nil.
+usage: (json-document-length DOC &rest PATH)  */)
+  (ptrdiff_t nargs, Lisp_Object *args)
+{
+  specpdl_ref count = SPECPDL_INDEX ();
+  CHECK_JSON_DOCUMENT (args[0]);
+  struct Lisp_JSON_Document *doc = XJSON_DOCUMENT (args[0]);
+
+  struct json_parser parser;
+  json_document_parser_init (&parser, doc);
+  record_unwind_protect_ptr (json_parser_done, &parser);
+  struct json_document_position p;
+  Lisp_Object result = Qnil;
+  if (json_document_lookup (&parser, doc, nargs - 1, args + 1, &p))
+    {
+      int c = SREF (doc->text, p.pos);
+      if (c == '[' || c == '{')
+	result = make_fixnum (doc->tape[p.tape].count);
+    }
+  return unbind_to (count, result);
+}
+
+DEFUN ("json-document-elements", Fjson_document_elements,
+       Sjson_document_elements, 1, MANY, 0,
+       doc: /* Return the elements of the array at PATH in DOC.
+The elements are returned as a list of JSON documents.  If the value
+at PATH is an object, return an alist of its members instead, whose
+keys are strings and whose values are JSON documents, in the order in
+which they appear in the text.  PATH is as for `json-document-get'.
+If the value at PATH is neither an array nor an object, or there is no
+value at PATH, return nil.
+usage: (json-document-elements DOC &rest PATH)  */)
+  (ptrdiff_t nargs, Lisp_Object *args)
+{
+  specpdl_ref count = SPECPDL_INDEX ();
+  CHECK_JSON_DOCUMENT (args[0]);
+  struct Lisp_JSON_Document *doc = XJSON_DOCUMENT (args[0]);
+
+  struct json_parser parser;
+  json_document_parser_init (&parser, doc);
+  record_unwind_protect_ptr (json_parser_done, &parser);
+  struct json_document_position p;
+  Lisp_Object result = Qnil;
+  if (json_document_lookup (&parser, doc, nargs - 1, args + 1, &p))
+    {
+      int c = SREF (doc->text, p.pos);
+      if (c == '[' || c == '{')
+	{
+	  ptrdiff_t n = doc->tape[p.tape].count;
+	  Lisp_Object *cdr = &result;
+	  json_document_enter (doc, &p);
+	  for (ptrdiff_t i = 0; i < n; i++)
+	    {
+	      Lisp_Object elt;
+	      if (c == '{')
+		{
+		  parser.input_current = SDATA (doc->text) + p.pos + 1;
+		  Lisp_Object key = json_parse_string (&parser, false, false);
+		  json_document_skip_key (doc, &p);
+		  elt = Fcons (key, make_json_document (doc, &p));
+		}
+	      else
+		elt = make_json_document (doc, &p);
+	      Lisp_Object nc = Fcons (elt, Qnil);
+	      *cdr = nc;
+	      cdr = xcdr_addr (nc);
+	      if (i + 1 < n)
+		json_document_next (doc, &p);
+	    }
+	}
+    }
+  return unbind_to (count, result);
+}
+
 void
 syms_of_json (void)
 {
@@ -1870,8 +2565,17 @@ syms_of_json (void)
   DEFSYM (Qplist, "plist");
   DEFSYM (Qarray, "array");
 
+  DEFSYM (Qjson_document, "json-document");
+  DEFSYM (Qjson_document_p, "json-document-p");
+
   defsubr (&Sjson_serialize);
   defsubr (&Sjson_insert);
   defsubr (&Sjson_parse_string);
   defsubr (&Sjson_parse_buffer);
+  defsubr (&Sjson_parse_document);
+  defsubr (&Sjson_document_p);
+  defsubr (&Sjson_document_get);
+  defsubr (&Sjson_document_at);
+  defsubr (&Sjson_document_length);
+  defsubr (&Sjson_document_elements);
 }
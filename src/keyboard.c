@@ -45,6 +45,10 @@ Copyright (C) 1985-1989, 1993-1997, 1999-2025 Free Software Foundation,
 #include "process.h"
 #include "menu.h"
 
+#ifdef HAVE_TREE_SITTER
+#include "treesit.h"
+#endif
+
 #ifdef HAVE_TEXT_CONVERSION
 #include "textconv.h"
 #endif /* HAVE_TEXT_CONVERSION */
@@ -1560,6 +1564,12 @@ command_loop_1 (void)
       last_point_position = last_pt;
       kset_last_prefix_arg (current_kboard, Vcurrent_prefix_arg);
 
+#ifdef HAVE_TREE_SITTER
+      /* Pick up tree-sitter parses that finished in the background
+	 while the command ran.  */
+      treesit_install_async_parses ();
+#endif
+
       safe_run_hooks_maybe_narrowed (Qpost_command_hook,
 				     XWINDOW (selected_window));
 
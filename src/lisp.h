@@ -1020,7 +1020,9 @@ DEFINE_GDB_SYMBOL_END (PSEUDOVECTOR_FLAG)
   PVEC_TS_PARSER,
   PVEC_TS_NODE,
   PVEC_TS_COMPILED_QUERY,
+  PVEC_TS_CURSOR,
   PVEC_SQLITE,
+  PVEC_JSON_DOCUMENT,
 
   /* These should be last, for internal_equal and sxhash_obj.  */
   PVEC_CLOSURE,
@@ -2930,6 +2932,41 @@ xmint_pointer (Lisp_Object a)
   bool is_statement;
 } GCALIGNED_STRUCT;
 
+/* A parsed JSON document whose values are made into Lisp objects
+   only when they are asked for.  See json.c.  */
+struct Lisp_JSON_Document
+{
+  union vectorlike_header header;
+
+  /* The JSON text, a unibyte string that is never modified.  */
+  Lisp_Object text;
+
+  /* The :null-object and :false-object of the document.  */
+  Lisp_Object null_object;
+  Lisp_Object false_object;
+
+  /* The document whose tape this one shares, or nil if this document
+     owns the tape.  */
+  Lisp_Object parent;
+
+  /* The rest is not visible to the GC.  */
+
+  /* The :object-type and :array-type of the document, as an enum
+     json_object_type and enum json_array_type.  */
+  int object_type;
+  int array_type;
+
+  /* The byte offset in TEXT of the value that this document stands
+     for, and the index in TAPE of the first array or object that
+     starts at or after it.  */
+  ptrdiff_t root;
+  ptrdiff_t root_tape;
+
+  /* The arrays and objects of TEXT, in the order in which they
+     start.  */
+  struct json_tape_entry *tape;
+} GCALIGNED_STRUCT;
+
 struct Lisp_User_Ptr
 {
   union vectorlike_header header;
@@ -3032,6 +3069,25 @@ XSQLITE (Lisp_Object a)
   return XUNTAG (a, Lisp_Vectorlike, struct Lisp_Sqlite);
 }
 
+INLINE bool
+JSON_DOCUMENTP (Lisp_Object x)
+{
+  return PSEUDOVECTORP (x, PVEC_JSON_DOCUMENT);
+}
+
+INLINE void
+CHECK_JSON_DOCUMENT (Lisp_Object x)
+{
+  CHECK_TYPE (JSON_DOCUMENTP (x), Qjson_document_p, x);
+}
+
+INLINE struct Lisp_JSON_Document *
+XJSON_DOCUMENT (Lisp_Object a)
+{
+  eassert (JSON_DOCUMENTP (a));
+  return XUNTAG (a, Lisp_Vectorlike, struct Lisp_JSON_Document);
+}
+
 INLINE bool
 BIGNUMP (Lisp_Object x)
 {
@@ -4257,6 +4313,7 @@ #define CONS_TO_INTEGER(cons, type, var)				\
 /* Defined in syntax.c.  */
 extern void init_syntax_once (void);
 extern void syms_of_syntax (void);
+extern void syntax_ppss_flush_checkpoints (struct buffer *, ptrdiff_t);
 
 /* Defined in fns.c.  */
 enum { NEXT_ALMOST_PRIME_LIMIT = 11 };
@@ -4332,6 +4389,11 @@ static_assert (FLT_RADIX == 2 || FLT_RADIX == 16);
 extern void syms_of_image (void);
 
 /* Defined in json.c.  */
+extern void json_check_parse_args (Lisp_Object);
+extern char *json_serialize_bytes (Lisp_Object, ptrdiff_t, Lisp_Object *,
+				   ptrdiff_t, ptrdiff_t *);
+extern Lisp_Object json_parse_bytes (const unsigned char *, ptrdiff_t,
+				     Lisp_Object);
 extern void syms_of_json (void);
 
 /* Defined in insdel.c.  */
@@ -4699,6 +4761,7 @@ #define ALLOCATE_ZEROED_PSEUDOVECTOR(type, field, tag)		       \
 #endif
 
 /* Defined in chartab.c.  */
+extern modiff_count char_table_modiff;
 extern Lisp_Object copy_char_table (Lisp_Object);
 extern Lisp_Object char_table_ref_and_range (Lisp_Object, int,
                                              int *, int *);
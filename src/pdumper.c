@@ -62,8 +62,6 @@
 
   - Nullify frame_and_buffer_state.
 
-  - Preferred base address for relocation-free non-PIC startup.
-
   - Compressed dump support.
 
 */
@@ -107,6 +105,18 @@ static_assert (sizeof (void (*) (void)) == sizeof (void *));
 static_assert (sizeof (ptrdiff_t) <= sizeof (Lisp_Object));
 static_assert (sizeof (ptrdiff_t) <= sizeof (EMACS_INT));
 
+/* Where we would like to load the dump.  The pointers in a dump file
+   are written for this address, so a dump that gets mapped there
+   needs no relocation of its pointers into itself, and only the pages
+   Emacs actually uses are read from the file.  The dump holds only
+   Lisp data, never code.  Zero means no preference; we use it where
+   the address space is too small to set a region aside.  */
+#if VM_SUPPORTED && UINTPTR_MAX >> 31 >> 31 != 0
+# define DUMP_PREFERRED_BASE ((uintptr_t) 0x4000000000)
+#else
+# define DUMP_PREFERRED_BASE ((uintptr_t) 0)
+#endif
+
 static size_t
 divide_round_up (size_t x, size_t y)
 {
@@ -353,7 +363,9 @@ dump_fingerprint (FILE *output, char const *label,
    The dump file can be loaded at arbitrary locations in memory, so it
    includes a table of relocations that let Emacs adjust the pointers
    embedded in the dump file to account for the location where it was
-   actually loaded.
+   actually loaded.  The pointers are written for the addresses in
+   DUMP_BASE and EMACS_BASIS, so when Emacs loads the dump there, the
+   relocations have nothing to do.
 
    Dump files can contain pointers to other objects in the dump file
    or to parts of the Emacs binary.  */
@@ -403,6 +415,11 @@ dump_fingerprint (FILE *output, char const *label,
 
   /* Offset of a vector of the dumped hash tables.  */
   dump_off hash_list;
+
+  /* The address of the dump, and the value of emacs_basis, for which
+     the pointers in the dump are written.  */
+  uintptr_t dump_base;
+  uintptr_t emacs_basis;
 };
 
 /* Double-ended singly linked list.  */
@@ -531,6 +548,10 @@ dump_fingerprint (FILE *output, char const *label,
   Lisp_Object current_referrer;
   bool have_current_referrer;
 
+  /* Whether to refuse objects that would not work after loading the
+     dump, instead of dumping them as dead objects.  */
+  bool strict;
+
   /* Queue of objects to dump.  */
   struct dump_queue dump_queue;
 
@@ -1380,29 +1401,37 @@ dump_enqueue_object (struct dump_context *ctx,
   dump_note_reachable (ctx, object);
 }
 
+/* Print the referrers of OBJECT at indentation LEVEL, and theirs
+   below each of them.  SEEN is a hash table of the referrers printed
+   so far: printing each of them once keeps cycles from looping and
+   shared structure from being printed over and over.  */
 static void
 print_paths_to_root_1 (struct dump_context *ctx,
                        Lisp_Object object,
-                       int level)
+                       int level,
+                       Lisp_Object seen)
 {
   Lisp_Object referrers = Fgethash (object, ctx->referrers, Qnil);
   while (!NILP (referrers))
     {
       Lisp_Object referrer = XCAR (referrers);
       referrers = XCDR (referrers);
+      if (!NILP (Fgethash (referrer, seen, Qnil)))
+	continue;
+      Fputhash (referrer, Qt, seen);
       Lisp_Object repr = Fprin1_to_string (referrer, Qnil, Qnil);
       for (int i = 0; i < level; ++i)
 	putc (' ', stderr);
       fwrite (SDATA (repr), 1, SBYTES (repr), stderr);
       putc ('\n', stderr);
-      print_paths_to_root_1 (ctx, referrer, level + 1);
+      print_paths_to_root_1 (ctx, referrer, level + 1, seen);
     }
 }
 
 static void
 print_paths_to_root (struct dump_context *ctx, Lisp_Object object)
 {
-  print_paths_to_root_1 (ctx, object, 0);
+  print_paths_to_root_1 (ctx, object, 0, make_eq_hash_table ());
 }
 
 static void
@@ -2237,6 +2266,7 @@ dump_treesit_compiled_query (struct dump_context *ctx,
   dump_field_lv (ctx, &out->language, query, &query->language, WEIGHT_STRONG);
   dump_field_lv (ctx, &out->source, query, &query->source, WEIGHT_STRONG);
   /* These will be recompiled after load from dump.  */
+  out->predicates = Qnil;
   out->query = NULL;
   out->cursor = NULL;
   return finish_dump_pvec (ctx, &out->header);
@@ -2689,14 +2719,15 @@ hash_table_std_test (const struct hash_table_test *t)
   error ("cannot dump hash tables with user-defined tests");  /* Bug#36769 */
 }
 
-/* Compact contents and discard inessential information from a hash table,
-   preparing it for dumping.
+/* Discard inessential information from a hash table, preparing it for
+   dumping.  The contents are dumped separately, compacted, by
+   dump_hash_table_contents.
    See `hash_table_thaw' for the code that restores the object to a usable
    state. */
 static void
 hash_table_freeze (struct Lisp_Hash_Table *h)
 {
-  h->key_and_value = hash_table_contents (h);
+  h->key_and_value = NULL;
   h->next = NULL;
   h->hash = NULL;
   h->index = NULL;
@@ -2712,6 +2743,7 @@ dump_hash_table_contents (struct dump_context *ctx, struct Lisp_Hash_Table *h)
   dump_align_output (ctx, DUMP_ALIGNMENT);
   dump_off start_offset = ctx->offset;
   ptrdiff_t n = 2 * h->count;
+  Lisp_Object *key_and_value = hash_table_contents (h);
 
   struct dump_flags old_flags = ctx->flags;
   ctx->flags.pack_objects = true;
@@ -2719,22 +2751,39 @@ dump_hash_table_contents (struct dump_context *ctx, struct Lisp_Hash_Table *h)
   for (ptrdiff_t i = 0; i < n; i++)
     {
       Lisp_Object out;
-      const Lisp_Object *slot = &h->key_and_value[i];
+      const Lisp_Object *slot = &key_and_value[i];
       dump_object_start (ctx, &out, sizeof out);
       dump_field_lv (ctx, &out, slot, slot, WEIGHT_STRONG);
       dump_object_finish (ctx, &out, sizeof out);
     }
 
   ctx->flags = old_flags;
+  hash_table_free_bytes (key_and_value, n * sizeof *key_and_value);
   return start_offset;
 }
 
+/* Dump the hash table OBJECT, but not its contents: the caller,
+   dump_drain_deferred_hash_tables, dumps them after all the tables.  */
 static dump_off
-dump_hash_table (struct dump_context *ctx, Lisp_Object object)
+dump_hash_table (struct dump_context *ctx, Lisp_Object object,
+		 dump_off offset)
 {
 #if CHECK_STRUCTS && !defined HASH_Lisp_Hash_Table_2A3C3E2B62
 # error "Lisp_Hash_Table changed. See CHECK_STRUCTS comment in config.h."
 #endif
+  if (ctx->flags.defer_hash_tables)
+    {
+      if (offset != DUMP_OBJECT_ON_HASH_TABLE_QUEUE)
+	{
+	  eassert (offset == DUMP_OBJECT_ON_NORMAL_QUEUE
+		   || offset == DUMP_OBJECT_NOT_SEEN);
+	  offset = DUMP_OBJECT_ON_HASH_TABLE_QUEUE;
+	  dump_remember_object (ctx, object, offset);
+	  dump_push (&ctx->deferred_hash_tables, object);
+	}
+      return offset;
+    }
+
   const struct Lisp_Hash_Table *hash_in = XHASH_TABLE (object);
   struct Lisp_Hash_Table hash_munged = *hash_in;
   struct Lisp_Hash_Table *hash = &hash_munged;
@@ -2748,16 +2797,10 @@ dump_hash_table (struct dump_context *ctx, Lisp_Object object)
   DUMP_FIELD_COPY (out, hash, weakness);
   DUMP_FIELD_COPY (out, hash, mutable);
   DUMP_FIELD_COPY (out, hash, frozen_test);
-  if (hash->key_and_value)
+  if (hash->count > 0)
     dump_field_fixup_later (ctx, out, hash, &hash->key_and_value);
   eassert (hash->next_weak == NULL);
-  dump_off offset = finish_dump_pvec (ctx, &out->header);
-  if (hash->key_and_value)
-    dump_remember_fixup_ptr_raw
-      (ctx,
-       offset + dump_offsetof (struct Lisp_Hash_Table, key_and_value),
-       dump_hash_table_contents (ctx, hash));
-  return offset;
+  return finish_dump_pvec (ctx, &out->header);
 }
 
 static dump_off
@@ -2808,7 +2851,7 @@ dump_obarray (struct dump_context *ctx, Lisp_Object object)
 static dump_off
 dump_buffer (struct dump_context *ctx, const struct buffer *in_buffer)
 {
-#if CHECK_STRUCTS && !defined HASH_buffer_E5E54A8C3F
+#if CHECK_STRUCTS && !defined HASH_buffer_5A876A2640
 # error "buffer changed. See CHECK_STRUCTS comment in config.h."
 #endif
   struct buffer munged_buffer = *in_buffer;
@@ -2826,6 +2869,8 @@ dump_buffer (struct dump_context *ctx, const struct buffer *in_buffer)
   buffer->clip_changed = 0;
   buffer->last_window_start = -1;
   buffer->point_before_scroll_ = Qnil;
+  buffer->ppss_checkpoints_ = Qnil;
+  buffer->own_text.ppss_checkpoints_end = BEG;
 
   dump_off base_offset = 0;
   if (buffer->base_buffer)
@@ -2878,6 +2923,7 @@ dump_buffer (struct dump_context *ctx, const struct buffer *in_buffer)
                             Lisp_Vectorlike, WEIGHT_NORMAL);
       DUMP_FIELD_COPY (out, buffer, own_text.inhibit_shrinking);
       DUMP_FIELD_COPY (out, buffer, own_text.redisplay);
+      DUMP_FIELD_COPY (out, buffer, own_text.ppss_checkpoints_end);
     }
 
   eassert (ctx->obj_offset > 0);
@@ -3064,7 +3110,7 @@ dump_vectorlike (struct dump_context *ctx,
                  Lisp_Object lv,
                  dump_off offset)
 {
-#if CHECK_STRUCTS && !defined HASH_pvec_type_99104541E2
+#if CHECK_STRUCTS && !defined HASH_pvec_type_D325153293
 # error "pvec_type changed. See CHECK_STRUCTS comment in config.h."
 #endif
   const struct Lisp_Vector *v = XVECTOR (lv);
@@ -3090,23 +3136,43 @@ dump_vectorlike (struct dump_context *ctx,
     case PVEC_BOOL_VECTOR:
       return dump_bool_vector(ctx, v);
     case PVEC_HASH_TABLE:
-      return dump_hash_table (ctx, lv);
+      return dump_hash_table (ctx, lv, offset);
     case PVEC_OBARRAY:
       return dump_obarray (ctx, lv);
     case PVEC_BUFFER:
       return dump_buffer (ctx, XBUFFER (lv));
     case PVEC_SUBR:
       return dump_subr (ctx, XSUBR (lv));
+    case PVEC_PROCESS:
+      if (ctx->strict)
+	error_unsupported_dump_object (ctx, lv, "process");
+      return dump_nilled_pseudovec (ctx, &v->header);
     case PVEC_FRAME:
+      /* The initial frame of a batch session, its windows and its
+	 terminal are recreated at startup, so even a strict dump can
+	 replace them.  */
+      if (ctx->strict && !FRAME_INITIAL_P (XFRAME (lv)))
+	error_unsupported_dump_object (ctx, lv, "frame");
+      return dump_nilled_pseudovec (ctx, &v->header);
     case PVEC_WINDOW:
-    case PVEC_PROCESS:
+      if (ctx->strict
+	  && ! (FRAMEP (XWINDOW (lv)->frame)
+		&& FRAME_INITIAL_P (XFRAME (XWINDOW (lv)->frame))))
+	error_unsupported_dump_object (ctx, lv, "window");
+      return dump_nilled_pseudovec (ctx, &v->header);
     case PVEC_TERMINAL:
+      if (ctx->strict && XTERMINAL (lv)->type != output_initial)
+	error_unsupported_dump_object (ctx, lv, "terminal");
       return dump_nilled_pseudovec (ctx, &v->header);
     case PVEC_MARKER:
       return dump_marker (ctx, XMARKER (lv));
     case PVEC_OVERLAY:
       return dump_overlay (ctx, XOVERLAY (lv));
     case PVEC_FINALIZER:
+      /* A finalizer that has yet to run would run in the new session,
+	 where whatever it cleans up is long gone.  */
+      if (ctx->strict && !NILP (XFINALIZER (lv)->function))
+	error_unsupported_dump_object (ctx, lv, "finalizer");
       return dump_finalizer (ctx, XFINALIZER (lv));
     case PVEC_BIGNUM:
       return dump_bignum (ctx, lv);
@@ -3135,11 +3201,13 @@ dump_vectorlike (struct dump_context *ctx,
     case PVEC_MUTEX:
     case PVEC_CONDVAR:
     case PVEC_SQLITE:
+    case PVEC_JSON_DOCUMENT:
     case PVEC_MODULE_FUNCTION:
     case PVEC_SYMBOL_WITH_POS:
     case PVEC_FREE:
     case PVEC_TS_PARSER:
     case PVEC_TS_NODE:
+    case PVEC_TS_CURSOR:
       break;
     }
   int iptype = ptype;
@@ -4113,8 +4181,29 @@ dump_drain_deferred_hash_tables (struct dump_context *ctx)
 
   Lisp_Object deferred_hash_tables = Fnreverse (ctx->deferred_hash_tables);
   ctx->deferred_hash_tables = Qnil;
+
+  /* Write the contents of the tables after all of them: the tables are
+     modified when they are thawed after loading the dump, and keeping
+     them together leaves most of the dump pages untouched, so they can
+     be shared between Emacs processes.  */
+  Lisp_Object contents = Qnil;
   while (!NILP (deferred_hash_tables))
-    dump_object (ctx, dump_pop (&deferred_hash_tables));
+    {
+      Lisp_Object table = dump_pop (&deferred_hash_tables);
+      dump_off offset = dump_object (ctx, table);
+      if (XHASH_TABLE (table)->count > 0)
+	dump_push (&contents, Fcons (dump_off_to_lisp (offset), table));
+    }
+  contents = Fnreverse (contents);
+  while (!NILP (contents))
+    {
+      Lisp_Object item = dump_pop (&contents);
+      dump_remember_fixup_ptr_raw
+	(ctx,
+	 dump_off_from_lisp (XCAR (item))
+	 + dump_offsetof (struct Lisp_Hash_Table, key_and_value),
+	 dump_hash_table_contents (ctx, XHASH_TABLE (XCDR (item))));
+    }
   ctx->flags = old_flags;
 }
 
@@ -4133,14 +4222,82 @@ dump_drain_deferred_symbols (struct dump_context *ctx)
   ctx->flags = old_flags;
 }
 
+/* Write the pointers in the dump of CTX for a dump loaded at
+   DUMP_PREFERRED_BASE in this Emacs, and record those addresses in the
+   header.  Until now, the targets of the dump relocations hold offsets
+   from the start of the dump or from emacs_basis; the relocations done
+   at load time only adjust them by how far the dump and Emacs moved
+   since.  Call this after the relocations are emitted.  */
+static void
+dump_prerelocate (struct dump_context *ctx)
+{
+  char *buf = ctx->buf;
+  const uintptr_t dump_base = DUMP_PREFERRED_BASE;
+  ctx->header.dump_base = dump_base;
+  ctx->header.emacs_basis = emacs_basis ();
+
+  for (int i = 0; i < RELOC_NUM_PHASES; ++i)
+    {
+      const struct dump_table_locator *table = &ctx->header.dump_relocs[i];
+      for (dump_off j = 0; j < table->nr_entries; ++j)
+	{
+	  struct dump_reloc reloc;
+	  memcpy (&reloc, buf + table->offset + j * sizeof reloc,
+		  sizeof reloc);
+	  char *target = buf + dump_reloc_get_offset (reloc);
+	  uintptr_t value;
+	  memcpy (&value, target, sizeof value);
+	  switch (reloc.type)
+	    {
+	    case RELOC_DUMP_TO_EMACS_PTR_RAW:
+	      value += emacs_basis ();
+	      memcpy (target, &value, sizeof value);
+	      break;
+	    case RELOC_DUMP_TO_DUMP_PTR_RAW:
+	      value += dump_base;
+	      memcpy (target, &value, sizeof value);
+	      break;
+	    case RELOC_NATIVE_COMP_UNIT:
+	    case RELOC_NATIVE_SUBR:
+	    case RELOC_BIGNUM:
+	      break;
+	    default:
+	      {
+		enum Lisp_Type lisp_type;
+		if (reloc.type < RELOC_DUMP_TO_EMACS_LV)
+		  {
+		    lisp_type = reloc.type - RELOC_DUMP_TO_DUMP_LV;
+		    value += dump_base;
+		  }
+		else
+		  {
+		    lisp_type = reloc.type - RELOC_DUMP_TO_EMACS_LV;
+		    value += emacs_basis ();
+		  }
+		Lisp_Object lv = (lisp_type == Lisp_Symbol
+				  ? make_lisp_symbol_internal ((void *) value)
+				  : make_lisp_ptr ((void *) value, lisp_type));
+		memcpy (target, &lv, sizeof lv);
+	      }
+	    }
+	}
+    }
+}
+
 DEFUN ("dump-emacs-portable",
        Fdump_emacs_portable, Sdump_emacs_portable,
-       1, 2, 0,
+       1, 3, 0,
        doc: /* Dump current state of Emacs into dump file FILENAME.
 If TRACK-REFERRERS is non-nil, keep additional debugging information
 that can help track down the provenance of unsupported object
-types.  */)
-     (Lisp_Object filename, Lisp_Object track_referrers)
+types.
+
+Processes, frames, windows and terminals are normally dumped as dead
+objects.  If STRICT is non-nil, signal an error instead if a process, a
+frame other than the initial one of a batch session, a window or
+terminal of such a frame, or a finalizer that has not run yet, can be
+reached from the state being dumped.  */)
+     (Lisp_Object filename, Lisp_Object track_referrers, Lisp_Object strict)
 {
   eassert (initialized);
 
@@ -4220,6 +4377,7 @@ DEFUN ("dump-emacs-portable",
   ctx->current_referrer = Qnil;
   if (!NILP (track_referrers))
     ctx->referrers = make_eq_hash_table ();
+  ctx->strict = !NILP (strict);
 
   ctx->dump_filename = filename;
 
@@ -4401,6 +4559,8 @@ DEFUN ("dump-emacs-portable",
     eassert (NILP (ctx->dump_relocs[i]));
   eassert (NILP (ctx->emacs_relocs));
 
+  dump_prerelocate (ctx);
+
   /* Dump is complete.  Go back to the header and write the magic
      indicating that the dump is complete and can be loaded.  */
   ctx->header.magic[0] = dump_magic[0];
@@ -4653,6 +4813,31 @@ dump_anonymous_allocate (void *base,
   return val;
 }
 
+/* Reserve SIZE bytes of address space, at HINT if that is free.  */
+
+static void *
+dump_reserve_address_space (void *hint, size_t size)
+{
+  void *ret = NULL;
+#if VM_SUPPORTED == VM_POSIX
+  /* Without MAP_FIXED, mmap maps somewhere else if something is at
+     HINT already.  */
+  ret = mmap (hint, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ret == MAP_FAILED)
+    ret = NULL;
+#elif VM_SUPPORTED == VM_MS_WINDOWS
+  if (hint)
+    ret = dump_anonymous_allocate (hint, size, DUMP_MEMORY_ACCESS_NONE);
+  if (!ret)
+    ret = dump_anonymous_allocate (NULL, size, DUMP_MEMORY_ACCESS_NONE);
+#else
+  (void) hint;
+  (void) size;
+  errno = ENOSYS;
+#endif
+  return ret;
+}
+
 #if VM_SUPPORTED == VM_MS_WINDOWS
 static void *
 dump_map_file_w32 (void *base, int fd, off_t offset, size_t size,
@@ -4969,7 +5154,7 @@ needs_mmap_retry_p (void)
 
 static bool
 dump_mmap_contiguous_vm (struct dump_memory_map *maps, int nr_maps,
-			 size_t total_size)
+			 size_t total_size, void *hint)
 {
   int save_errno;
   bool ret = false;
@@ -4988,8 +5173,7 @@ dump_mmap_contiguous_vm (struct dump_memory_map *maps, int nr_maps,
         }
 
       eassert (resv == NULL);
-      resv = dump_anonymous_allocate (NULL, total_size,
-                                      DUMP_MEMORY_ACCESS_NONE);
+      resv = dump_reserve_address_space (hint, total_size);
       if (!resv)
 	goto out;
 
@@ -5068,9 +5252,11 @@ dump_mmap_contiguous_vm (struct dump_memory_map *maps, int nr_maps,
    Each mapping SIZE must be a multiple of the system page size except
    for the last mapping.
 
+   Put the memory at HINT if possible; HINT may be NULL.
+
    Return true on success or false on failure with errno set.  */
 static bool
-dump_mmap_contiguous (struct dump_memory_map *maps, int nr_maps)
+dump_mmap_contiguous (struct dump_memory_map *maps, int nr_maps, void *hint)
 {
   if (!nr_maps)
     return true;
@@ -5089,7 +5275,7 @@ dump_mmap_contiguous (struct dump_memory_map *maps, int nr_maps)
     }
 
   if (VM_SUPPORTED)
-    return dump_mmap_contiguous_vm (maps, nr_maps, total_size);
+    return dump_mmap_contiguous_vm (maps, nr_maps, total_size, hint);
   else
     return dump_mmap_contiguous_heap (maps, nr_maps, total_size);
 }
@@ -5172,6 +5358,9 @@ dump_bitset_clear (struct dump_bitset *bitset)
   struct dump_header header;
   /* Mark bits for objects in the dump; used during GC.  */
   struct dump_bitset mark_bits, last_mark_bits;
+  /* How far the dump and the Emacs image are from the addresses for
+     which the pointers in the dump are written.  */
+  intptr_t dump_delta, emacs_delta;
   /* Time taken to load the dump.  */
   double load_time;
   /* Dump file name.  */
@@ -5372,38 +5561,34 @@ dump_reloc_size (const struct dump_reloc reloc)
   return sizeof (Lisp_Object);
 }
 
-static Lisp_Object
-dump_make_lv_from_reloc (const uintptr_t dump_base,
-			 const struct dump_reloc reloc)
+/* Return how much the Lisp_Object that the Lisp value relocation
+   RELOC points at changes because of where the dump and Emacs are.  A
+   symbol is an offset from lispsym, which moves with Emacs.  */
+static intptr_t
+dump_lv_reloc_delta (const struct dump_reloc reloc)
 {
-  const dump_off reloc_offset = dump_reloc_get_offset (reloc);
-  uintptr_t value = dump_read_word_from_dump (dump_base, reloc_offset);
   enum Lisp_Type lisp_type;
+  intptr_t delta;
 
   if (RELOC_DUMP_TO_DUMP_LV <= reloc.type
       && reloc.type < RELOC_DUMP_TO_EMACS_LV)
     {
       lisp_type = reloc.type - RELOC_DUMP_TO_DUMP_LV;
-      value += dump_base;
-      eassert (pdumper_object_p ((void *) value));
+      delta = dump_private.dump_delta;
     }
   else
     {
       eassert (RELOC_DUMP_TO_EMACS_LV <= reloc.type);
       eassert (reloc.type < RELOC_DUMP_TO_EMACS_LV + 8);
       lisp_type = reloc.type - RELOC_DUMP_TO_EMACS_LV;
-      value += emacs_basis ();
+      delta = dump_private.emacs_delta;
     }
 
   eassert (lisp_type != Lisp_Int0 && lisp_type != Lisp_Int1);
 
-  Lisp_Object lv;
   if (lisp_type == Lisp_Symbol)
-    lv = make_lisp_symbol ((void *) value);
-  else
-    lv = make_lisp_ptr ((void *) value, lisp_type);
-
-  return lv;
+    delta -= dump_private.emacs_delta;
+  return delta;
 }
 
 /* Actually apply a dump relocation.  */
@@ -5419,21 +5604,26 @@ dump_do_dump_relocation (const uintptr_t dump_base,
   switch (reloc.type)
     {
     case RELOC_DUMP_TO_EMACS_PTR_RAW:
-      {
-        uintptr_t value = dump_read_word_from_dump (dump_base, reloc_offset);
-        eassert (dump_reloc_size (reloc) == sizeof (value));
-        value += emacs_basis ();
-        dump_write_word_to_dump (dump_base, reloc_offset, value);
-        break;
-      }
+      /* Leave the page alone if the pointer is already right.  */
+      if (dump_private.emacs_delta)
+	{
+	  uintptr_t value = dump_read_word_from_dump (dump_base,
+						       reloc_offset);
+	  eassert (dump_reloc_size (reloc) == sizeof (value));
+	  value += dump_private.emacs_delta;
+	  dump_write_word_to_dump (dump_base, reloc_offset, value);
+	}
+      break;
     case RELOC_DUMP_TO_DUMP_PTR_RAW:
-      {
-        uintptr_t value = dump_read_word_from_dump (dump_base, reloc_offset);
-        eassert (dump_reloc_size (reloc) == sizeof (value));
-        value += dump_base;
-        dump_write_word_to_dump (dump_base, reloc_offset, value);
-        break;
-      }
+      if (dump_private.dump_delta)
+	{
+	  uintptr_t value = dump_read_word_from_dump (dump_base,
+						       reloc_offset);
+	  eassert (dump_reloc_size (reloc) == sizeof (value));
+	  value += dump_private.dump_delta;
+	  dump_write_word_to_dump (dump_base, reloc_offset, value);
+	}
+      break;
 #ifdef HAVE_NATIVE_COMP
     case RELOC_NATIVE_COMP_UNIT:
       {
@@ -5557,9 +5747,15 @@ dump_do_dump_relocation (const uintptr_t dump_base,
       }
     default: /* Lisp_Object in the dump; precise type in reloc.type */
       {
-        Lisp_Object lv = dump_make_lv_from_reloc (dump_base, reloc);
-        eassert (dump_reloc_size (reloc) == sizeof (lv));
-        dump_write_lv_to_dump (dump_base, reloc_offset, lv);
+	intptr_t delta = dump_lv_reloc_delta (reloc);
+	if (delta)
+	  {
+	    Lisp_Object lv;
+	    eassert (dump_reloc_size (reloc) == sizeof (lv));
+	    memcpy (&lv, dump_ptr (dump_base, reloc_offset), sizeof (lv));
+	    lv = XIL ((EMACS_UINT) XLI (lv) + delta);
+	    dump_write_lv_to_dump (dump_base, reloc_offset, lv);
+	  }
         break;
       }
     }
@@ -5788,7 +5984,8 @@ pdumper_load (const char *dump_filename, char *argv0)
      .protection = DUMP_MEMORY_ACCESS_READWRITE,
     };
 
-  if (!dump_mmap_contiguous (sections, ARRAYELTS (sections)))
+  if (!dump_mmap_contiguous (sections, ARRAYELTS (sections),
+			     (void *) header->dump_base))
     goto out;
 
   err = PDUMPER_LOAD_ERROR;
@@ -5820,6 +6017,8 @@ pdumper_load (const char *dump_filename, char *argv0)
   dump_private.last_mark_bits = mark_bits[1];
   dump_public.start = dump_base;
   dump_public.end = dump_public.start + dump_size;
+  dump_private.dump_delta = dump_base - header->dump_base;
+  dump_private.emacs_delta = emacs_basis () - header->emacs_basis;
 
   dump_do_all_dump_reloc_for_phase (header, dump_base, EARLY_RELOCS);
   dump_do_all_emacs_relocations (header, dump_base);
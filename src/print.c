@@ -2094,6 +2094,22 @@ print_vectorlike_unreadable (Lisp_Object obj, Lisp_Object printcharfun,
 #endif
       break;
 
+    case PVEC_TS_CURSOR:
+#ifdef HAVE_TREE_SITTER
+      print_c_string ("#<treesit-cursor>", printcharfun);
+      return;
+#endif
+      break;
+
+    case PVEC_JSON_DOCUMENT:
+      {
+	print_c_string ("#<json-document ", printcharfun);
+	int i = sprintf (buf, "%"pD"d bytes>",
+			 SBYTES (XJSON_DOCUMENT (obj)->text));
+	strout (buf, i, i, printcharfun);
+      }
+      return;
+
     case PVEC_SQLITE:
       {
 	print_c_string ("#<sqlite ", printcharfun);
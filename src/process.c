@@ -93,6 +93,7 @@ #define HAVE_LOCAL_SOCKETS
 #endif
 
 #include <c-ctype.h>
+#include <c-strcase.h>
 #include <flexmember.h>
 #include <nproc.h>
 #include <sig2str.h>
@@ -115,6 +116,7 @@ #define HAVE_LOCAL_SOCKETS
 #include "sysselect.h"
 #include "syssignal.h"
 #include "syswait.h"
+#include "pdumper.h"
 #ifdef HAVE_GNUTLS
 #include "gnutls.h"
 #endif
@@ -135,6 +137,14 @@ #define HAVE_LOCAL_SOCKETS
 #endif
 #endif
 
+/* Wait with epoll where it is available and nothing else (Glib, NS
+   or Android) needs to own the call to pselect.  */
+#if (defined HAVE_SYS_EPOLL_H && defined HAVE_EPOLL_CREATE1 \
+     && !defined HAVE_GLIB && !defined HAVE_NS && !defined HAVE_ANDROID)
+# define USE_EPOLL
+# include <sys/epoll.h>
+#endif
+
 #if defined HAVE_GETADDRINFO_A || defined HAVE_GNUTLS
 /* This is 0.1s in nanoseconds. */
 #define ASYNC_RETRY_NSEC 100000000
@@ -255,6 +265,10 @@ #define READ_OUTPUT_DELAY_INCREMENT (TIMESPEC_HZ / 100)
 #define READ_OUTPUT_DELAY_MAX       (READ_OUTPUT_DELAY_INCREMENT * 5)
 #define READ_OUTPUT_DELAY_MAX_MAX   (READ_OUTPUT_DELAY_INCREMENT * 7)
 
+/* Size up to which the chunks in which a process's output is read
+   grow while its output keeps filling them.  */
+#define READ_OUTPUT_GROWTH_MAX (1024 * 1024)
+
 /* Number of processes which have a non-zero read_output_delay,
    and therefore might be delayed for adaptive read buffering.  */
 
@@ -428,6 +442,26 @@ pset_stderrproc (struct Lisp_Process *p, Lisp_Object val)
 {
   p->stderrproc = val;
 }
+static void
+pset_json_rpc (struct Lisp_Process *p, Lisp_Object val)
+{
+  p->json_rpc = val;
+}
+static void
+pset_json_rpc_pending (struct Lisp_Process *p, Lisp_Object val)
+{
+  p->json_rpc_pending = val;
+}
+static void
+pset_json_rpc_headers (struct Lisp_Process *p, Lisp_Object val)
+{
+  p->json_rpc_headers = val;
+}
+static void
+pset_json_rpc_queue (struct Lisp_Process *p, Lisp_Object val)
+{
+  p->json_rpc_queue = val;
+}
 
 
 static Lisp_Object
@@ -476,6 +510,193 @@ clear_fd_callback_data (struct fd_callback_data* elem)
   elem->waiting_thread = NULL;
 }
 
+#ifdef USE_EPOLL
+
+/* wait_reading_process_output can wait with epoll rather than
+   pselect.  pselect makes the kernel poll every descriptor in the
+   masks on each call, so that the cost of a wakeup grows with the
+   number of subprocesses and connections even when only one of them
+   has output.  An epoll instance keeps its interest set between
+   calls: epoll_prepare brings it in line with the masks, which
+   usually means no system call at all, and epoll_select then only
+   hears about the descriptors that are ready.
+
+   The interest set mirrors the masks of the last wait, so a
+   descriptor should leave it before it is closed, or the number could
+   be reused for another file that the kernel would never report.
+   Every descriptor that can appear in the masks is registered in
+   fd_callback_info, and removing it from there calls epoll_forget;
+   deactivate_process does that before it closes the descriptors of a
+   process.  Code outside this file may close a descriptor first.  The
+   kernel then drops the registration itself once the last reference
+   to the open file is closed, and epoll_forget only has to clear
+   epoll_registered.  Until then, epoll_select may hear about the
+   closed descriptor, but it ignores descriptors not in the masks.  */
+
+/* The epoll instance, or -1 if it has not been created yet.  */
+static int epoll_fd = -1;
+
+/* True if creating the epoll instance failed; use pselect.  */
+static bool epoll_unavailable;
+
+/* The events, FOR_READ and FOR_WRITE from enum fd_bits, for which
+   each descriptor is registered in epoll_fd.  */
+static unsigned char epoll_registered[FD_SETSIZE];
+
+/* All registered descriptors are below this.  */
+static int epoll_fd_limit;
+
+/* Remove FD from the interest set of epoll_fd.  Called when FD is no
+   longer monitored, before it is closed.  */
+
+static void
+epoll_forget (int fd)
+{
+  if (epoll_registered[fd])
+    {
+      epoll_ctl (epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+      epoll_registered[fd] = 0;
+    }
+}
+
+/* Make the interest set of epoll_fd consist of the descriptors below
+   NFDS in RFDS and WFDS, which may be null.  Return true if
+   epoll_select can then be used to wait on them.  Only the main
+   thread uses epoll_fd; other threads wait with different masks,
+   possibly at the same time, so they use pselect.  */
+
+static bool
+epoll_prepare (int nfds, fd_set *rfds, fd_set *wfds)
+{
+  if (epoll_unavailable || !main_thread_p (current_thread))
+    return false;
+  if (epoll_fd < 0)
+    {
+      epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+      if (epoll_fd < 0)
+	{
+	  epoll_unavailable = true;
+	  return false;
+	}
+    }
+
+  int limit = max (nfds, epoll_fd_limit);
+  epoll_fd_limit = 0;
+  for (int fd = 0; fd < limit; fd++)
+    {
+      int want = 0;
+      if (fd < nfds)
+	{
+	  if (rfds && FD_ISSET (fd, rfds))
+	    want |= FOR_READ;
+	  if (wfds && FD_ISSET (fd, wfds))
+	    want |= FOR_WRITE;
+	}
+
+      if (want != epoll_registered[fd])
+	{
+	  struct epoll_event event;
+	  event.events = (((want & FOR_READ) ? EPOLLIN : 0)
+			  | ((want & FOR_WRITE) ? EPOLLOUT : 0));
+	  event.data.fd = fd;
+
+	  if (!want)
+	    /* This fails if FD was closed, which is fine.  */
+	    epoll_ctl (epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+	  else if (! (epoll_registered[fd]
+		      && epoll_ctl (epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0)
+		   && epoll_ctl (epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+	    {
+	      /* epoll refuses regular files, for instance.  Leave
+		 FD out of the interest set and let pselect wait.  */
+	      epoll_registered[fd] = 0;
+	      epoll_fd_limit = limit;
+	      return false;
+	    }
+	  epoll_registered[fd] = want;
+	}
+
+      if (epoll_registered[fd])
+	epoll_fd_limit = fd + 1;
+    }
+
+  return true;
+}
+
+/* A replacement for pselect, for use after epoll_prepare has
+   succeeded with the same arguments.  */
+
+static int
+epoll_select (int nfds, fd_set *rfds, fd_set *wfds, fd_set *efds,
+	      const struct timespec *timeout, const sigset_t *sigmask)
+{
+  fd_set rset, wset;
+  struct epoll_event events[64];
+  int msecs = -1;
+
+  if (timeout)
+    msecs = (timeout->tv_sec < INT_MAX / 1000 - 1
+	     ? (timeout->tv_sec * 1000
+		+ (timeout->tv_nsec + 999999) / 1000000)
+	     : INT_MAX);
+
+  int n = epoll_pwait (epoll_fd, events, ARRAYELTS (events), msecs,
+		       sigmask);
+  if (n < 0)
+    return n;
+
+  if (rfds)
+    {
+      rset = *rfds;
+      FD_ZERO (rfds);
+    }
+  if (wfds)
+    {
+      wset = *wfds;
+      FD_ZERO (wfds);
+    }
+  if (n == 0)
+    return 0;
+
+  int nready = 0;
+  for (int i = 0; i < n; i++)
+    {
+      int fd = events[i].data.fd;
+      uint32_t revents = events[i].events;
+
+      /* These are the conditions under which pselect would report
+	 FD as readable or writable.  */
+      if (rfds && FD_ISSET (fd, &rset)
+	  && (revents & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+	{
+	  FD_SET (fd, rfds);
+	  nready++;
+	}
+      if (wfds && FD_ISSET (fd, &wset)
+	  && (revents & (EPOLLOUT | EPOLLERR)))
+	{
+	  FD_SET (fd, wfds);
+	  nready++;
+	}
+    }
+
+  if (nready == 0)
+    {
+      /* Only events that pselect would not report, such as a hangup
+	 on a descriptor waited on for writing.  Let pselect wait
+	 rather than spin on them.  */
+      if (rfds)
+	*rfds = rset;
+      if (wfds)
+	*wfds = wset;
+      return pselect (nfds, rfds, wfds, efds, timeout, sigmask);
+    }
+
+  return nready;
+}
+
+#endif	/* USE_EPOLL */
+
 
 /* Add a file descriptor FD to be monitored for when read is possible.
    When read is possible, call FUNC with argument DATA.  */
@@ -578,6 +799,9 @@ delete_write_fd (int fd)
   if (fd_callback_info[fd].flags == 0)
     {
       clear_fd_callback_data (&fd_callback_info[fd]);
+#ifdef USE_EPOLL
+      epoll_forget (fd);
+#endif
 
       if (fd == max_desc)
 	recompute_max_desc ();
@@ -902,7 +1126,7 @@ allocate_pty (char pty_name[PTY_NAME_SIZE])
 static struct Lisp_Process *
 allocate_process (void)
 {
-  return ALLOCATE_ZEROED_PSEUDOVECTOR (struct Lisp_Process, thread,
+  return ALLOCATE_ZEROED_PSEUDOVECTOR (struct Lisp_Process, json_rpc_queue,
 				       PVEC_PROCESS);
 }
 
@@ -1415,6 +1639,78 @@ DEFUN ("process-filter", Fprocess_filter, Sprocess_filter,
   return XPROCESS (process)->filter;
 }
 
+DEFUN ("process-output-statistics", Fprocess_output_statistics,
+       Sprocess_output_statistics, 1, 1, 0,
+       doc: /* Return statistics about the output read from PROCESS.
+The value is an alist with the following elements:
+
+ bytes       -- number of bytes of output read, modulo the largest
+                unsigned integer Emacs can represent in C
+ reads       -- number of reads that returned output
+ filter-time -- time spent in the filter, or inserting the output
+                when PROCESS uses the default filter, in Lisp
+                timestamp format
+ read-size   -- number of bytes the next read asks for at most
+
+The read size starts out as `read-process-output-max', and grows
+while the output arrives faster than it can be read.  */)
+  (Lisp_Object process)
+{
+  CHECK_PROCESS (process);
+  struct Lisp_Process *p = XPROCESS (process);
+  return list4 (Fcons (Qbytes, make_uint (p->nbytes_read)),
+		Fcons (Qreads, make_uint (p->nreads)),
+		Fcons (Qfilter_time, make_lisp_time (p->filter_time)),
+		Fcons (Qread_size, make_int (p->readmax)));
+}
+
+DEFUN ("set-process-json-rpc-framing", Fset_process_json_rpc_framing,
+       Sset_process_json_rpc_framing, 2, MANY, 0,
+       doc: /* Make the filter of PROCESS receive JSON-RPC messages if FLAG is non-nil.
+The output of PROCESS is then split into messages framed as in the
+Language Server Protocol: header lines, one of which is
+"Content-Length: N", an empty line, and a body of N bytes.  The body
+of each message is parsed as JSON.  Instead of a string, the filter of
+PROCESS is called with PROCESS and a list of the values parsed from
+the messages that each read completes.  If FLAG is `text', each
+element of the list is instead a cons (VALUE . TEXT), where TEXT is
+the body of the message as a unibyte string.  The output is not
+decoded first; the JSON text must be UTF-8.
+
+ARGS are keyword arguments that control how the JSON is parsed, as
+for `json-parse-string', which see.
+
+For a message whose body is not valid JSON, the filter is instead
+called with three arguments: PROCESS, the body as a unibyte string,
+and the error data, as in `condition-case'.  If FLAG is nil, the
+filter receives strings again, and any part of a message that was
+received is discarded; otherwise, it is kept.
+usage: (set-process-json-rpc-framing PROCESS FLAG &rest ARGS)  */)
+  (ptrdiff_t nargs, Lisp_Object *args)
+{
+  Lisp_Object process = args[0];
+  CHECK_PROCESS (process);
+  struct Lisp_Process *p = XPROCESS (process);
+  Lisp_Object parse_args = Qnil;
+
+  if (!NILP (args[1]))
+    {
+      parse_args = Fvector (nargs - 2, args + 2);
+      json_check_parse_args (parse_args);
+    }
+  if (NILP (parse_args) || NILP (p->json_rpc))
+    {
+      pset_json_rpc_pending (p, Qnil);
+      pset_json_rpc_headers (p, Qnil);
+      pset_json_rpc_queue (p, Qnil);
+      p->json_rpc_fill = 0;
+      p->json_rpc_length = 0;
+    }
+  pset_json_rpc (p, parse_args);
+  p->json_rpc_text = EQ (args[1], Qtext);
+  return Qnil;
+}
+
 DEFUN ("set-process-sentinel", Fset_process_sentinel, Sset_process_sentinel,
        2, 2, 0,
        doc: /* Give PROCESS the sentinel SENTINEL; nil for default.
@@ -4834,18 +5130,6 @@ deactivate_process (Lisp_Object proc)
       p->read_output_skip = 0;
     }
 
-  /* Beware SIGCHLD hereabouts.  */
-
-  for (i = 0; i < PROCESS_OPEN_FDS; i++)
-    {
-      if (p->open_fd[i] >= 0)
-	{
-	  fd_callback_info[p->open_fd[i]].thread = NULL;
-	  fd_callback_info[p->open_fd[i]].waiting_thread = NULL;
-	}
-      close_process_fd (&p->open_fd[i]);
-    }
-
   inchannel = p->infd;
   eassert (inchannel < FD_SETSIZE);
   if (inchannel >= 0)
@@ -4865,6 +5149,19 @@ deactivate_process (Lisp_Object proc)
       if ((fd_callback_info[inchannel].flags & NON_BLOCKING_CONNECT_FD) != 0)
 	delete_write_fd (inchannel);
     }
+
+  /* Beware SIGCHLD hereabouts.  Stop monitoring the descriptors before
+     closing them; see epoll_forget.  */
+
+  for (i = 0; i < PROCESS_OPEN_FDS; i++)
+    {
+      if (p->open_fd[i] >= 0)
+	{
+	  fd_callback_info[p->open_fd[i]].thread = NULL;
+	  fd_callback_info[p->open_fd[i]].waiting_thread = NULL;
+	}
+      close_process_fd (&p->open_fd[i]);
+    }
 }
 
 
@@ -5807,6 +6104,15 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 			    &Available, (check_write ? &Writeok : 0),
 			    NULL, &timeout, NULL);
 #else  /* !HAVE_GLIB */
+#ifdef USE_EPOLL
+	  if (epoll_prepare (max_desc + 1, &Available,
+			     (check_write ? &Writeok : 0)))
+	    nfds = thread_select (epoll_select, max_desc + 1,
+				  &Available,
+				  (check_write ? &Writeok : 0),
+				  NULL, &timeout, NULL);
+	  else
+#endif	/* USE_EPOLL */
 	  nfds = thread_select (pselect, max_desc + 1,
 				&Available,
 				(check_write ? &Writeok : 0),
@@ -6205,19 +6511,114 @@ read_process_output_error_handler (Lisp_Object error_val)
 
 static void read_and_dispose_of_process_output (struct Lisp_Process *, char *,
 						ssize_t,
-						struct coding_system *);
+						struct coding_system *,
+						bool);
 
 static void read_and_insert_process_output (struct Lisp_Process *, char *,
 					    ssize_t,
-					    struct coding_system *);
+					    struct coding_system *,
+					    bool);
+
+/* Return the address at which to read the output of process P from
+   CHANNEL directly into the gap of its buffer, after making room there
+   for READMAX bytes, or NULL if the output must be read elsewhere.
+
+   This is possible when the default filter will insert the output at
+   the process mark, the mark is in the accessible portion of the
+   buffer, CODING leaves it unchanged if it is ASCII, and preparing the
+   buffer for the insertion cannot run Lisp code that would move the
+   gap.  Whether the output is ASCII is known only after
+   reading it; see read_and_insert_process_output.  */
+
+static char *
+read_process_output_gap (struct Lisp_Process *p, int channel,
+			 struct coding_system *coding, ptrdiff_t readmax)
+{
+  struct buffer *b, *old = current_buffer;
+  struct Lisp_Marker *mark = XMARKER (p->mark);
+  char *gap = NULL;
+
+  if (! (fast_read_process_output
+	 && EQ (p->filter, Qinternal_default_process_filter)
+	 && BUFFERP (p->buffer)
+	 && (b = XBUFFER (p->buffer), BUFFER_LIVE_P (b))
+	 && !b->base_buffer
+	 && (!mark->buffer || mark->buffer == b)
+	 && NILP (p->json_rpc)
+	 && p->decoding_carryover == 0
+	 && coding->carryover_bytes == 0
+	 && proc_buffered_char[channel] < 0
+#ifdef DATAGRAM_SOCKETS
+	 && !DATAGRAM_CHAN_P (channel)
+#endif
+#ifdef HAVE_GNUTLS
+	 && !p->gnutls_p
+#endif
+	 ))
+    return NULL;
+
+  set_buffer_internal (b);
+  /* Otherwise read_process_output_before_insert puts point, and so the
+     output, elsewhere.  */
+  if ((!mark->buffer || (BEGV <= mark->charpos && mark->charpos <= ZV))
+      && EQ (BVAR (b, undo_list), Qt)
+      && (NILP (BVAR (b, enable_multibyte_characters))
+	  ? !CODING_MAY_REQUIRE_DECODING (coding)
+	  : coding_decodes_ascii_unchanged (coding))
+      && (inhibit_modification_hooks
+	  || (NILP (BVAR (b, filename))
+	      && NILP (BVAR (b, mark_active))
+	      && NILP (Vbefore_change_functions)
+	      && (SAVE_MODIFF < MODIFF || NILP (Vfirst_change_hook))
+	      && !buffer_has_overlays ())))
+    {
+      if (mark->buffer)
+	move_gap_both (mark->charpos, mark->bytepos);
+      else
+	move_gap_both (ZV, ZV_BYTE);
+      if (GAP_SIZE < readmax)
+	make_gap (readmax - GAP_SIZE);
+      if (!pdumper_object_p (BEG_ADDR))
+	gap = (char *) GPT_ADDR;
+    }
+  set_buffer_internal (old);
+  return gap;
+}
+
+/* Adapt the size of the chunks in which the output of process P is
+   read from CHANNEL, after a read of NBYTES into a chunk of READMAX.
+   Output that fills the chunk is likely followed by more, so read it
+   in larger chunks, up to READ_OUTPUT_GROWTH_MAX, and call the filter
+   less often.  Return to `read-process-output-max' once the output
+   slows down.  */
+
+static void
+adapt_process_readmax (struct Lisp_Process *p, int channel,
+		       ptrdiff_t nbytes, ptrdiff_t readmax)
+{
+  ptrdiff_t base = clip_to_bounds (1, read_process_output_max, INT_MAX);
+
+  if (nbytes == readmax && readmax < READ_OUTPUT_GROWTH_MAX)
+    {
+      p->readmax = min (readmax * 2, READ_OUTPUT_GROWTH_MAX);
+#if defined F_SETPIPE_SZ && defined F_GETPIPE_SZ
+      /* A pipe must hold that much for a read to return it.  */
+      if (!p->pty_in && p->readmax > fcntl (channel, F_GETPIPE_SZ))
+	fcntl (channel, F_SETPIPE_SZ, p->readmax);
+#endif
+    }
+  else if (readmax > base && nbytes < readmax / 16)
+    p->readmax = max (base, readmax / 2);
+}
 
 /* Read pending output from the process channel,
    starting with our buffered-ahead character if we have one.
    Yield number of decoded characters read,
    or -1 (setting errno) if there is a read error.
 
-   This function reads at most read_process_output_max bytes.
-   If you want to read all available subprocess output,
+   This function reads at most PROC's readmax bytes, which starts out
+   as read_process_output_max.  If you want to read all available
+   subprocess output,
    you must call it repeatedly until it returns zero.
 
    The characters read are decoded according to PROC's coding-system
@@ -6234,14 +6635,18 @@ read_process_output (Lisp_Object proc, int channel)
   ptrdiff_t readmax = p->readmax;
   specpdl_ref count = SPECPDL_INDEX ();
   Lisp_Object odeactivate;
-  char *chars;
+  char *chars = read_process_output_gap (p, channel, coding, readmax);
+  bool in_gap = chars != NULL;
 
   USE_SAFE_ALLOCA;
-  chars = SAFE_ALLOCA (sizeof coding->carryover + readmax);
+  if (!in_gap)
+    {
+      chars = SAFE_ALLOCA (sizeof coding->carryover + readmax);
 
-  if (carryover)
-    /* See the comment above.  */
-    memcpy (chars, SDATA (p->decoding_buf), carryover);
+      if (carryover)
+	/* See the comment above.  */
+	memcpy (chars, SDATA (p->decoding_buf), carryover);
+    }
 
 #ifdef DATAGRAM_SOCKETS
   /* We have a working select, so proc_buffered_char is always -1.  */
@@ -6295,6 +6700,8 @@ read_process_output (Lisp_Object proc, int channel)
 	      process_output_skip = 1;
 	    }
 	}
+      if (nbytes >= 0)
+	adapt_process_readmax (p, channel, nbytes, readmax - buffered);
       nbytes += buffered;
       nbytes += buffered && nbytes <= 0;
     }
@@ -6316,6 +6723,7 @@ read_process_output (Lisp_Object proc, int channel)
 
   /* Ignore carryover, it's been added by a previous iteration already.  */
   p->nbytes_read += nbytes;
+  p->nreads += nbytes > 0;
 
   /* Now set NBYTES how many bytes we must decode.  */
   nbytes += carryover;
@@ -6326,7 +6734,10 @@ read_process_output (Lisp_Object proc, int channel)
      friends don't expect current-buffer to be changed from under them.  */
   record_unwind_current_buffer ();
 
-  read_and_dispose_of_process_output (p, chars, nbytes, coding);
+  struct timespec start = current_timespec ();
+  read_and_dispose_of_process_output (p, chars, nbytes, coding, in_gap);
+  p->filter_time = timespec_add (p->filter_time,
+				 timespec_sub (current_timespec (), start));
 
   /* Handling the process output should not deactivate the mark.  */
   Vdeactivate_mark = odeactivate;
@@ -6446,10 +6857,15 @@ read_process_output_set_last_coding_system (struct Lisp_Process *p,
     }
 }
 
+/* Insert the output BUF of NREAD bytes of process P into its buffer,
+   decoding it with PROCESS_CODING.  IN_GAP means that BUF is in the
+   gap of the buffer; see read_process_output_gap.  */
+
 static void
 read_and_insert_process_output (struct Lisp_Process *p, char *buf,
 				ssize_t nread,
-				struct coding_system *process_coding)
+				struct coding_system *process_coding,
+				bool in_gap)
 {
   if (!nread || NILP (p->buffer) || !BUFFER_LIVE_P (XBUFFER (p->buffer)))
     return;
@@ -6466,8 +6882,34 @@ read_and_insert_process_output (struct Lisp_Process *p, char *buf,
   /* Adapted from call_process.  */
   prepare_to_modify_buffer (PT, PT, NULL);
 
-  if (NILP (BVAR (XBUFFER (p->buffer), enable_multibyte_characters))
-	   && ! CODING_MAY_REQUIRE_DECODING (process_coding))
+  bool multibyte
+    = !NILP (BVAR (XBUFFER (p->buffer), enable_multibyte_characters));
+  USE_SAFE_ALLOCA;
+
+  if (in_gap)
+    {
+      /* Nothing has moved the gap since the output was read.  Unless
+	 the output needs decoding, it is already where it belongs.  */
+      eassert (buf == (char *) GPT_ADDR && PT == GPT);
+      if (multibyte)
+	for (ssize_t i = 0; i < nread; i++)
+	  if (buf[i] & 0x80)
+	    {
+	      buf = memcpy (SAFE_ALLOCA (nread), buf, nread);
+	      in_gap = false;
+	      break;
+	    }
+    }
+
+  if (in_gap)
+    {
+      insert_from_gap (nread, nread, false, true);
+      TEMP_SET_PT_BOTH (PT + nread, PT_BYTE + nread);
+      if (multibyte)
+	read_process_output_set_last_coding_system (p, process_coding);
+      signal_after_change (PT - nread, 0, nread);
+    }
+  else if (!multibyte && ! CODING_MAY_REQUIRE_DECODING (process_coding))
     {
       /* For compatibility with the long-standing behavior of
 	 internal-default-process-filter we insert before markers,
@@ -6503,12 +6945,237 @@ read_and_insert_process_output (struct Lisp_Process *p, char *buf,
 
   read_process_output_after_insert (p, &old_read_only, old_begv, old_zv,
 				    before, before_byte, opoint, opoint_byte);
+  SAFE_FREE ();
+}
+
+/* The largest size of the headers of a JSON-RPC message.  */
+enum { JSON_RPC_HEADERS_MAX = 1024 };
+
+/* Return the length given by the Content-Length header among the
+   NBYTES bytes of headers at HEADERS, or -1 if there is none.  */
+
+static ptrdiff_t
+json_rpc_content_length (const char *headers, ptrdiff_t nbytes)
+{
+  static char const name[] = "Content-Length:";
+  const char *end = headers + nbytes;
+
+  for (const char *line = headers; line < end; )
+    {
+      const char *eol = memchr (line, '\n', end - line);
+      if (!eol)
+	eol = end;
+      if (eol - line > sizeof name - 1
+	  && c_strncasecmp (line, name, sizeof name - 1) == 0)
+	{
+	  const char *q = line + sizeof name - 1;
+	  while (q < eol && *q == ' ')
+	    q++;
+	  if (! (q < eol && c_isdigit (*q)))
+	    return -1;
+	  ptrdiff_t length = 0;
+	  for (; q < eol && c_isdigit (*q); q++)
+	    if (ckd_mul (&length, length, 10)
+		|| ckd_add (&length, length, *q - '0'))
+	      return -1;
+	  return length <= STRING_BYTES_BOUND ? length : -1;
+	}
+      line = eol + 1;
+    }
+  return -1;
+}
+
+/* Return the body in ARGS as a unibyte string.  */
+
+static Lisp_Object
+json_rpc_body_string (Lisp_Object *args)
+{
+  char *begin = xmint_pointer (args[0]);
+  char *end = xmint_pointer (args[1]);
+  return (STRINGP (args[3]) ? args[3]
+	  : make_unibyte_string (begin, end - begin));
+}
+
+static Lisp_Object
+json_rpc_parse (ptrdiff_t nargs, Lisp_Object *args)
+{
+  unsigned char *begin = xmint_pointer (args[0]);
+  unsigned char *end = xmint_pointer (args[1]);
+  Lisp_Object value = json_parse_bytes (begin, end - begin, args[2]);
+  return NILP (args[4]) ? value : Fcons (value, json_rpc_body_string (args));
+}
+
+/* Return a queue entry for the body in ARGS that is not valid JSON,
+   which no JSON value can be mistaken for.  */
+
+static Lisp_Object
+json_rpc_parse_error (Lisp_Object error, ptrdiff_t nargs, Lisp_Object *args)
+{
+  return Fcons (Qunbound, Fcons (error, json_rpc_body_string (args)));
+}
+
+/* Parse the JSON-RPC message body of NBYTES at BODY for process P,
+   and push the value onto MESSAGES, or an entry for the body if it is
+   not valid JSON.  STRING is a unibyte string with just the body, or
+   nil if the body is not in a string.  */
+
+static void
+json_rpc_parse_body (struct Lisp_Process *p, unsigned char *body,
+		     ptrdiff_t nbytes, Lisp_Object string,
+		     Lisp_Object *messages)
+{
+  Lisp_Object args[] = { make_mint_ptr (body), make_mint_ptr (body + nbytes),
+			 p->json_rpc, string,
+			 p->json_rpc_text ? Qt : Qnil };
+  *messages = Fcons (internal_condition_case_n (json_rpc_parse,
+						ARRAYELTS (args), args,
+						Qerror,
+						json_rpc_parse_error),
+		     *messages);
+}
+
+/* Split the NBYTES bytes of output at CHARS from process P into
+   JSON-RPC messages, and return a list of the parsed bodies of those
+   that are complete.  Keep the rest in P until more output arrives.
+   A body that arrives in one piece is parsed where it was read.  The
+   string for a body that arrives in pieces grows with them, so that a
+   bogus Content-Length costs no more memory than the output.
+   This runs no Lisp code, so that output read meanwhile cannot
+   overtake the output at CHARS.  */
+
+static Lisp_Object
+frame_json_rpc_output (struct Lisp_Process *p, char *chars, ptrdiff_t nbytes)
+{
+  Lisp_Object messages = Qnil;
+  char *end = chars + nbytes;
+
+  while (chars < end)
+    {
+      ptrdiff_t fill = p->json_rpc_fill;
+
+      if (p->json_rpc_length == 0)
+	{
+	  /* Collect the headers, up to the empty line after them.  */
+	  if (NILP (p->json_rpc_headers))
+	    pset_json_rpc_headers (p, make_uninit_string (JSON_RPC_HEADERS_MAX));
+	  char *headers = SSDATA (p->json_rpc_headers);
+	  bool complete = false;
+	  while (chars < end && !complete)
+	    {
+	      if (fill == JSON_RPC_HEADERS_MAX)
+		{
+		  /* This is not a message.  Skip it, except for the
+		     start of a possible empty line.  */
+		  memmove (headers, headers + fill - 3, 3);
+		  fill = 3;
+		}
+	      headers[fill++] = *chars++;
+	      complete = (fill >= 4
+			  && memcmp (headers + fill - 4, "\r\n\r\n", 4) == 0);
+	    }
+	  if (!complete)
+	    {
+	      p->json_rpc_fill = fill;
+	      break;
+	    }
+
+	  ptrdiff_t length = json_rpc_content_length (headers, fill);
+	  p->json_rpc_fill = 0;
+	  if (length < 0)
+	    continue;
+	  if (length <= end - chars)
+	    {
+	      json_rpc_parse_body (p, (unsigned char *) chars, length, Qnil,
+				   &messages);
+	      chars += length;
+	      continue;
+	    }
+	  pset_json_rpc_pending (p, make_uninit_string
+				    (min (length, max (end - chars,
+						       JSON_RPC_HEADERS_MAX))));
+	  p->json_rpc_length = length;
+	}
+      else
+	{
+	  /* Add to the part of the body received so far.  */
+	  ptrdiff_t length = p->json_rpc_length;
+	  ptrdiff_t n = min (end - chars, length - fill);
+	  Lisp_Object body = p->json_rpc_pending;
+	  if (SBYTES (body) < fill + n)
+	    {
+	      ptrdiff_t size = min (length, max (fill + n, 2 * SBYTES (body)));
+	      body = make_uninit_string (size);
+	      memcpy (SDATA (body), SDATA (p->json_rpc_pending), fill);
+	      pset_json_rpc_pending (p, body);
+	    }
+	  memcpy (SDATA (body) + fill, chars, n);
+	  chars += n;
+	  fill += n;
+	  if (fill < length)
+	    {
+	      p->json_rpc_fill = fill;
+	      break;
+	    }
+
+	  pset_json_rpc_pending (p, Qnil);
+	  p->json_rpc_fill = 0;
+	  p->json_rpc_length = 0;
+	  /* The string now holds exactly the body.  */
+	  json_rpc_parse_body (p, SDATA (body), length, body, &messages);
+	}
+    }
+
+  return Fnreverse (messages);
+}
+
+/* Pass the JSON-RPC messages in the NBYTES bytes of output at CHARS
+   from process P to its filter, in a single list.  The body of a
+   message that is not valid JSON is passed as a string by itself,
+   with the error.
+   The messages are queued first, so that a filter that reads more
+   output from P, for instance with `accept-process-output', still
+   sees them in order.  */
+
+static void
+read_and_dispose_of_json_rpc_output (struct Lisp_Process *p, char *chars,
+				     ssize_t nbytes)
+{
+  Lisp_Object messages = frame_json_rpc_output (p, chars, nbytes);
+  pset_json_rpc_queue (p, nconc2 (p->json_rpc_queue, messages));
+
+  while (CONSP (p->json_rpc_queue))
+    {
+      Lisp_Object queue = p->json_rpc_queue, call;
+      if (CONSP (XCAR (queue)) && BASE_EQ (XCAR (XCAR (queue)), Qunbound))
+	{
+	  Lisp_Object invalid = XCDR (XCAR (queue));
+	  call = list4 (p->filter, make_lisp_proc (p), XCDR (invalid),
+			XCAR (invalid));
+	  pset_json_rpc_queue (p, XCDR (queue));
+	}
+      else
+	{
+	  /* Take the messages up to the next invalid one.  */
+	  Lisp_Object tail = queue;
+	  while (CONSP (XCDR (tail))
+		 && ! (CONSP (XCAR (XCDR (tail)))
+		       && BASE_EQ (XCAR (XCAR (XCDR (tail))), Qunbound)))
+	    tail = XCDR (tail);
+	  pset_json_rpc_queue (p, XCDR (tail));
+	  XSETCDR (tail, Qnil);
+	  call = list3 (p->filter, make_lisp_proc (p), queue);
+	}
+      internal_condition_case_1 (read_process_output_call, call,
+				 !NILP (Vdebug_on_error) ? Qnil : Qerror,
+				 read_process_output_error_handler);
+    }
 }
 
 static void
 read_and_dispose_of_process_output (struct Lisp_Process *p, char *chars,
 				    ssize_t nbytes,
-				    struct coding_system *coding)
+				    struct coding_system *coding,
+				    bool in_gap)
 {
   Lisp_Object outstream = p->filter;
   Lisp_Object text;
@@ -6544,11 +7211,14 @@ read_and_dispose_of_process_output (struct Lisp_Process *p, char *chars,
      save the match data in a special nonrecursive fashion.  */
   running_asynch_code = 1;
 
-  if (fast_read_process_output
-      && EQ (p->filter, Qinternal_default_process_filter))
-    read_and_insert_process_output (p, chars, nbytes, coding);
+  if (!NILP (p->json_rpc))
+    read_and_dispose_of_json_rpc_output (p, chars, nbytes);
+  else if (fast_read_process_output
+	   && EQ (p->filter, Qinternal_default_process_filter))
+    read_and_insert_process_output (p, chars, nbytes, coding, in_gap);
   else
     {
+      eassert (!in_gap);
       decode_coding_c_string (coding, (unsigned char *) chars, nbytes, Qt);
       text = coding->dst_object;
 
@@ -6986,6 +7656,55 @@ DEFUN ("process-send-string", Fprocess_send_string, Sprocess_send_string,
 		SBYTES (string), string);
   return Qnil;
 }
+
+DEFUN ("json-send-to-process", Fjson_send_to_process, Sjson_send_to_process,
+       3, MANY, 0,
+       doc: /* Send PROCESS the JSON representation of OBJECT as input.
+This is like (process-send-string PROCESS (json-serialize OBJECT ...)),
+but the JSON text is sent from where it is built.  It is copied to a
+string only if it must be encoded for PROCESS, or if the part that
+PROCESS does not accept at once has to wait for it.  See
+`json-serialize' for the allowed values of OBJECT and ARGS; a buffer
+in OBJECT stands for the text of its accessible portion, which is read
+without copying it to a string.
+
+If FRAMING is non-nil, the text is preceded by a "Content-Length"
+header, so that it makes one JSON-RPC message in the framing that
+`set-process-json-rpc-framing' splits output into.  If FRAMING is
+`text', also return the JSON text, without the header, as a unibyte
+string; otherwise, return nil.  Serialization errors are signaled
+before any of the text is sent.
+usage: (json-send-to-process PROCESS OBJECT FRAMING &rest ARGS)  */)
+  (ptrdiff_t nargs, Lisp_Object *args)
+{
+  specpdl_ref count = SPECPDL_INDEX ();
+  Lisp_Object proc = get_process (args[0]);
+  Lisp_Object framing = args[2];
+
+  /* Serialize with room for a header before the text, so that header
+     and text go out in one send_process call.  Another message sent
+     while this one waits for the pipe then cannot come between
+     them.  */
+  enum { HEADROOM = (sizeof "Content-Length: \r\n\r\n" - 1
+		     + INT_STRLEN_BOUND (ptrdiff_t)) };
+  ptrdiff_t nbytes;
+  char *buf = json_serialize_bytes (args[1], nargs - 3, args + 3,
+				    HEADROOM, &nbytes);
+  record_unwind_protect_ptr (xfree, buf);
+  char *start = buf + HEADROOM;
+  Lisp_Object text = (EQ (framing, Qtext)
+		      ? make_unibyte_string (start, nbytes) : Qnil);
+  if (!NILP (framing))
+    {
+      char header[HEADROOM + 1];
+      int n = sprintf (header, "Content-Length: %"pD"d\r\n\r\n", nbytes);
+      start -= n;
+      memcpy (start, header, n);
+      nbytes += n;
+    }
+  send_process (proc, start, nbytes, Qnil);
+  return unbind_to (count, text);
+}
 
 /* Return the foreground process group for the tty/pty that
    the process P uses.  */
@@ -8352,6 +9071,9 @@ delete_keyboard_wait_descriptor (int desc)
   eassert (desc >= 0 && desc < FD_SETSIZE);
 
   clear_fd_callback_data (&fd_callback_info[desc]);
+#ifdef USE_EPOLL
+  epoll_forget (desc);
+#endif
 
   if (desc == max_desc)
     recompute_max_desc ();
@@ -8878,6 +9600,10 @@ syms_of_process (void)
 	  "internal-default-process-sentinel");
   DEFSYM (Qinternal_default_process_filter,
 	  "internal-default-process-filter");
+  DEFSYM (Qbytes, "bytes");
+  DEFSYM (Qreads, "reads");
+  DEFSYM (Qfilter_time, "filter-time");
+  DEFSYM (Qread_size, "read-size");
 #endif
   DEFSYM (Qpri, "pri");
   DEFSYM (Qnice, "nice");
@@ -8950,7 +9676,8 @@ syms_of_process (void)
   DEFVAR_INT ("read-process-output-max", read_process_output_max,
 	      doc: /* Maximum number of bytes to read from subprocess in a single chunk.
 Enlarge the value only if the subprocess generates very large (megabytes)
-amounts of data in one go.
+amounts of data in one go.  Output that keeps filling the chunks is
+read in larger chunks, up to a megabyte, until it slows down again.
 
 On GNU/Linux systems, the value should not exceed
 /proc/sys/fs/pipe-max-size.  See pipe(7) manpage for details.  */);
@@ -8995,6 +9722,8 @@ syms_of_process (void)
   defsubr (&Sprocess_mark);
   defsubr (&Sset_process_filter);
   defsubr (&Sprocess_filter);
+  defsubr (&Sprocess_output_statistics);
+  defsubr (&Sset_process_json_rpc_framing);
   defsubr (&Sset_process_sentinel);
   defsubr (&Sprocess_sentinel);
   defsubr (&Sset_process_thread);
@@ -9024,6 +9753,7 @@ syms_of_process (void)
   defsubr (&Saccept_process_output);
   defsubr (&Sprocess_send_region);
   defsubr (&Sprocess_send_string);
+  defsubr (&Sjson_send_to_process);
   defsubr (&Sinternal_default_interrupt_process);
   defsubr (&Sinterrupt_process);
   defsubr (&Skill_process);
@@ -124,6 +124,24 @@ #define EMACS_PROCESS_H
 
     /* The thread a process is linked to, or nil for any thread.  */
     Lisp_Object thread;
+
+    /* If non-nil, a vector of arguments for `json-parse-string' with
+       which to parse the JSON-RPC messages the output is split into.
+       See `set-process-json-rpc-framing'.  */
+    Lisp_Object json_rpc;
+
+    /* Unibyte string holding the part of the body of the current
+       message received so far, or nil.  It grows as more of the body
+       arrives.  */
+    Lisp_Object json_rpc_pending;
+
+    /* Unibyte string in which the headers of each message are
+       collected, or nil until the first message.  */
+    Lisp_Object json_rpc_headers;
+
+    /* Parsed messages not yet passed to the filter, and the messages
+       that are not valid JSON as (unbound ERROR . BODY).  */
+    Lisp_Object json_rpc_queue;
     /* After this point, there are no Lisp_Objects.  */
 
     /* Process ID.  A positive value is a child process ID.
@@ -136,6 +154,15 @@ #define EMACS_PROCESS_H
     int infd;
     /* Byte-count modulo (UINTMAX_MAX + 1) for process output read from `infd'.  */
     uintmax_t nbytes_read;
+    /* Number of reads that returned output from `infd'.  */
+    uintmax_t nreads;
+    /* Time spent handling that output, in the filter or inserting it.  */
+    struct timespec filter_time;
+    /* Number of bytes of json_rpc_headers or json_rpc_pending in use.  */
+    ptrdiff_t json_rpc_fill;
+    /* Length of the body of the current JSON-RPC message, or zero
+       while its headers are being read.  */
+    ptrdiff_t json_rpc_length;
     /* Descriptor by which we write to this process.  */
     int outfd;
     /* Descriptors that were created for this process and that need
@@ -160,6 +187,9 @@ #define EMACS_PROCESS_H
     unsigned int adaptive_read_buffering : 2;
     /* Skip reading this process on next read.  */
     bool_bf read_output_skip : 1;
+    /* True if the filter receives the text of each JSON-RPC message
+       along with its value.  */
+    bool_bf json_rpc_text : 1;
     /* Maximum number of bytes to read in a single chunk. */
     ptrdiff_t readmax;
     /* True means kill silently if Emacs is exited.
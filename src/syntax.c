@@ -187,6 +187,8 @@ SYNTAX_COMEND_FIRST (int c)
 static void internalize_parse_state (Lisp_Object, struct lisp_parse_state *);
 static bool in_classes (int c, int num_classes, const unsigned char *classes);
 static void parse_sexp_propertize (ptrdiff_t charpos);
+static ptrdiff_t ppss_checkpoint_before (ptrdiff_t);
+static void ppss_checkpoint_parse (ptrdiff_t, struct lisp_parse_state *);
 
 /* This setter is used only in this file, so it can be private.  */
 static void
@@ -711,6 +713,14 @@ back_comment (ptrdiff_t from, ptrdiff_t from_byte, ptrdiff_t stop,
   int c;
   int syntax = 0;
   unsigned short int quit_count = 0;
+  /* The last `syntax-ppss' checkpoint before the comment-end, or 0 if
+     we can't use the checkpoints.  Once the scan has gone back that
+     far, parsing forward from there is cheaper than going on, and it
+     gets the right answer.  This matters for long block comments.  */
+  ptrdiff_t checkpoint = 0;
+
+  if (!NILP (Vcomment_use_syntax_ppss) && BEGV == BEG)
+    checkpoint = ppss_checkpoint_before (comment_end);
 
   /* FIXME: A }} comment-ender style leads to incorrect behavior
      in the case of {{ c }}} because we ignore the last two chars which are
@@ -726,6 +736,9 @@ back_comment (ptrdiff_t from, ptrdiff_t from_byte, ptrdiff_t stop,
       int prev_syntax;
       bool com2start, com2end, comstart;
 
+      if (from == checkpoint)
+	goto lossage;
+
       /* Move back and examine a character.  */
       dec_both (&from, &from_byte);
       UPDATE_SYNTAX_TABLE_BACKWARD (from);
@@ -910,8 +923,9 @@ back_comment (ptrdiff_t from, ptrdiff_t from_byte, ptrdiff_t stop,
 	 Scan fwd from a known safe place (beginning-of-defun)
 	 to the one in question; this records where we
 	 last passed a comment starter.  */
-      /* If we did not already find the defun start, find it now.  */
-      if (defun_start == 0)
+      /* If we did not already find the defun start, find it now,
+	 unless we can start from a `syntax-ppss' checkpoint.  */
+      if (defun_start == 0 && checkpoint == 0)
 	{
 	  defun_start = find_defun_start (comment_end, comment_end_byte);
 	  defun_start_byte = find_start_value_byte;
@@ -919,11 +933,16 @@ back_comment (ptrdiff_t from, ptrdiff_t from_byte, ptrdiff_t stop,
 	}
       do
 	{
-          internalize_parse_state (Qnil, &state);
-	  scan_sexps_forward (&state,
-			      defun_start, defun_start_byte,
-			      comment_end, TYPE_MINIMUM (EMACS_INT),
-			      0, 0);
+	  if (defun_start == 0)
+	    ppss_checkpoint_parse (comment_end, &state);
+	  else
+	    {
+	      internalize_parse_state (Qnil, &state);
+	      scan_sexps_forward (&state,
+				  defun_start, defun_start_byte,
+				  comment_end, TYPE_MINIMUM (EMACS_INT),
+				  0, 0);
+	    }
 	  defun_start = comment_end;
 	  if (!adjusted)
 	    {
@@ -956,6 +975,8 @@ back_comment (ptrdiff_t from, ptrdiff_t from_byte, ptrdiff_t stop,
       while (defun_start < comment_end);
 
       from_byte = CHAR_TO_BYTE (from);
+      if (from > BEGV)
+	UPDATE_SYNTAX_TABLE_BACKWARD (from - 1);
       UPDATE_SYNTAX_TABLE_FORWARD (from - 1);
     }
 
@@ -3544,6 +3565,41 @@ internalize_parse_state (Lisp_Object external, struct lisp_parse_state *state)
     }
 }
 
+/* Convert an internal parse state to the list returned by
+   parse-partial-sexp.  */
+static Lisp_Object
+externalize_parse_state (struct lisp_parse_state *state)
+{
+  return
+    Fcons (make_fixnum (state->depth),
+	   Fcons (state->prevlevelstart < 0
+		  ? Qnil : make_fixnum (state->prevlevelstart),
+	     Fcons (state->thislevelstart < 0
+		    ? Qnil : make_fixnum (state->thislevelstart),
+	       Fcons (state->instring >= 0
+		      ? (state->instring == ST_STRING_STYLE
+			 ? Qt : make_fixnum (state->instring)) : Qnil,
+		 Fcons (state->incomment < 0 ? Qt :
+			(state->incomment == 0 ? Qnil :
+			 make_fixnum (state->incomment)),
+		   Fcons (state->quoted ? Qt : Qnil,
+		     Fcons (make_fixnum (state->mindepth),
+		       Fcons ((state->comstyle
+			       ? (state->comstyle == ST_COMMENT_STYLE
+				  ? Qsyntax_table
+				  : make_fixnum (state->comstyle))
+			       : Qnil),
+		         Fcons (((state->incomment
+                                  || (state->instring >= 0))
+                                 ? make_fixnum (state->comstr_start)
+                                 : Qnil),
+			   Fcons (state->levelstarts,
+                             Fcons (state->prev_syntax == Smax
+                                    ? Qnil
+                                    : make_fixnum (state->prev_syntax),
+                                Qnil)))))))))));
+}
+
 DEFUN ("parse-partial-sexp", Fparse_partial_sexp, Sparse_partial_sexp, 2, 6, 0,
        doc: /* Parse Lisp syntax starting at FROM until TO; return status of parse at TO.
 Parsing stops at TO or when certain criteria are met;
@@ -3610,34 +3666,202 @@ DEFUN ("parse-partial-sexp", Fparse_partial_sexp, Sparse_partial_sexp, 2, 6, 0,
 
   SET_PT_BOTH (state.location, state.location_byte);
 
-  return
-    Fcons (make_fixnum (state.depth),
-	   Fcons (state.prevlevelstart < 0
-		  ? Qnil : make_fixnum (state.prevlevelstart),
-	     Fcons (state.thislevelstart < 0
-		    ? Qnil : make_fixnum (state.thislevelstart),
-	       Fcons (state.instring >= 0
-		      ? (state.instring == ST_STRING_STYLE
-			 ? Qt : make_fixnum (state.instring)) : Qnil,
-		 Fcons (state.incomment < 0 ? Qt :
-			(state.incomment == 0 ? Qnil :
-			 make_fixnum (state.incomment)),
-		   Fcons (state.quoted ? Qt : Qnil,
-		     Fcons (make_fixnum (state.mindepth),
-		       Fcons ((state.comstyle
-			       ? (state.comstyle == ST_COMMENT_STYLE
-				  ? Qsyntax_table
-				  : make_fixnum (state.comstyle))
-			       : Qnil),
-		         Fcons (((state.incomment
-                                  || (state.instring >= 0))
-                                 ? make_fixnum (state.comstr_start)
-                                 : Qnil),
-			   Fcons (state.levelstarts,
-                             Fcons (state.prev_syntax == Smax
-                                    ? Qnil
-                                    : make_fixnum (state.prev_syntax),
-                                Qnil)))))))))));
+  return externalize_parse_state (&state);
+}
+
+/* The `syntax-ppss' checkpoints of a buffer are the parse states from
+   the beginning of the buffer to every SYNTAX_PPSS_CHECKPOINT_INTERVAL
+   characters.  They are kept in the ppss_checkpoints field of the
+   buffer, a vector with the following slots.  In addition, the
+   ppss_checkpoints_end field of the buffer text bounds the positions of
+   the checkpoints of all the buffers sharing that text.  */
+
+enum ppss_checkpoint_slot
+  {
+    PPSS_CHECKPOINT_TABLE,	/* The syntax table they were computed with.  */
+    PPSS_CHECKPOINT_LOOKUP,	/* The value of parse-sexp-lookup-properties.  */
+    PPSS_CHECKPOINT_ESCAPE,	/* The value of comment-end-can-be-escaped.  */
+    PPSS_CHECKPOINT_COUNT,	/* The number of valid checkpoints.  */
+    PPSS_CHECKPOINT_STATES,	/* A vector of the checkpoint states.  */
+    PPSS_CHECKPOINT_SLOTS
+  };
+
+enum { SYNTAX_PPSS_CHECKPOINT_INTERVAL = 2000 };
+
+/* Return the `syntax-ppss' checkpoints of the current buffer, creating
+   them if necessary.  Discard the existing checkpoints if the syntax
+   table or the variables that affect parsing have changed.  */
+
+static Lisp_Object
+ppss_checkpoints (void)
+{
+  Lisp_Object checkpoints = BVAR (current_buffer, ppss_checkpoints);
+  Lisp_Object table = BVAR (current_buffer, syntax_table);
+  Lisp_Object lookup = parse_sexp_lookup_properties ? Qt : Qnil;
+  Lisp_Object escape = comment_end_can_be_escaped ? Qt : Qnil;
+
+  if (NILP (checkpoints))
+    {
+      checkpoints = make_nil_vector (PPSS_CHECKPOINT_SLOTS);
+      ASET (checkpoints, PPSS_CHECKPOINT_COUNT, make_fixnum (0));
+      ASET (checkpoints, PPSS_CHECKPOINT_STATES, make_nil_vector (16));
+      bset_ppss_checkpoints (current_buffer, checkpoints);
+    }
+  else if (! (EQ (AREF (checkpoints, PPSS_CHECKPOINT_TABLE), table)
+	      && EQ (AREF (checkpoints, PPSS_CHECKPOINT_LOOKUP), lookup)
+	      && EQ (AREF (checkpoints, PPSS_CHECKPOINT_ESCAPE), escape)))
+    ASET (checkpoints, PPSS_CHECKPOINT_COUNT, make_fixnum (0));
+
+  ASET (checkpoints, PPSS_CHECKPOINT_TABLE, table);
+  ASET (checkpoints, PPSS_CHECKPOINT_LOOKUP, lookup);
+  ASET (checkpoints, PPSS_CHECKPOINT_ESCAPE, escape);
+  return checkpoints;
+}
+
+/* Discard the `syntax-ppss' checkpoints of BUF that lie after POS.  */
+
+static void
+flush_ppss_checkpoints (struct buffer *buf, ptrdiff_t pos)
+{
+  Lisp_Object checkpoints = BVAR (buf, ppss_checkpoints);
+
+  if (!NILP (checkpoints))
+    {
+      ptrdiff_t valid = (max (pos, BEG) - BEG) / SYNTAX_PPSS_CHECKPOINT_INTERVAL;
+
+      if (valid < XFIXNUM (AREF (checkpoints, PPSS_CHECKPOINT_COUNT)))
+	ASET (checkpoints, PPSS_CHECKPOINT_COUNT, make_fixnum (valid));
+    }
+}
+
+/* Discard the `syntax-ppss' checkpoints after POS of BUF and of the
+   other buffers that share its text.  This is called before the text
+   of BUF is changed at POS.  */
+
+void
+syntax_ppss_flush_checkpoints (struct buffer *buf, ptrdiff_t pos)
+{
+  struct buffer *base = buf->base_buffer ? buf->base_buffer : buf;
+  Lisp_Object tail, buffer;
+
+  if (buf->text->ppss_checkpoints_end <= pos)
+    return;
+
+  if (base->indirections <= 0)
+    flush_ppss_checkpoints (base, pos);
+  else
+    FOR_EACH_LIVE_BUFFER (tail, buffer)
+      if (XBUFFER (buffer) == base || XBUFFER (buffer)->base_buffer == base)
+	flush_ppss_checkpoints (XBUFFER (buffer), pos);
+  buf->text->ppss_checkpoints_end = max (pos, BEG);
+}
+
+/* Return the position of the last `syntax-ppss' checkpoint of the
+   current buffer at or before POS, or 0 if there is none beyond the
+   beginning of the buffer.  Unlike ppss_checkpoints, this creates
+   nothing, and ignores checkpoints computed with different parsing
+   settings.  */
+
+static ptrdiff_t
+ppss_checkpoint_before (ptrdiff_t pos)
+{
+  Lisp_Object checkpoints = BVAR (current_buffer, ppss_checkpoints);
+
+  if (NILP (checkpoints)
+      || ! (EQ (AREF (checkpoints, PPSS_CHECKPOINT_TABLE),
+		BVAR (current_buffer, syntax_table))
+	    && EQ (AREF (checkpoints, PPSS_CHECKPOINT_LOOKUP),
+		   parse_sexp_lookup_properties ? Qt : Qnil)
+	    && EQ (AREF (checkpoints, PPSS_CHECKPOINT_ESCAPE),
+		   comment_end_can_be_escaped ? Qt : Qnil)))
+    return 0;
+
+  ptrdiff_t i = min ((pos - BEG) / SYNTAX_PPSS_CHECKPOINT_INTERVAL,
+		     XFIXNUM (AREF (checkpoints, PPSS_CHECKPOINT_COUNT)));
+  return i > 0 ? BEG + i * SYNTAX_PPSS_CHECKPOINT_INTERVAL : 0;
+}
+
+/* Store in *STATE the parse state at TO, parsing from the beginning of
+   the current buffer, which must not be narrowed.  Parse from the
+   nearest checkpoint before TO, recording the checkpoints on the way.  */
+
+static void
+ppss_checkpoint_parse (ptrdiff_t to, struct lisp_parse_state *state)
+{
+  EMACS_INT target = TYPE_MINIMUM (EMACS_INT);
+  ptrdiff_t last = (to - BEG) / SYNTAX_PPSS_CHECKPOINT_INTERVAL;
+  Lisp_Object checkpoints = ppss_checkpoints ();
+  Lisp_Object states = AREF (checkpoints, PPSS_CHECKPOINT_STATES);
+  ptrdiff_t i = min (last,
+		     XFIXNUM (AREF (checkpoints, PPSS_CHECKPOINT_COUNT)));
+  ptrdiff_t start = BEG + i * SYNTAX_PPSS_CHECKPOINT_INTERVAL;
+
+  internalize_parse_state (i > 0 ? AREF (states, i - 1) : Qnil, state);
+  state->location = start;
+  state->location_byte = CHAR_TO_BYTE (start);
+
+  /* Record the states at the checkpoints up to TO.  */
+  for (; i < last; i++)
+    {
+      scan_sexps_forward (state, state->location, state->location_byte,
+			  start + SYNTAX_PPSS_CHECKPOINT_INTERVAL,
+			  target, false, 0);
+      start = state->location;
+
+      /* Parsing may have run Lisp code that flushed the checkpoints,
+	 in which case those after them would be of no use.  */
+      if (XFIXNUM (AREF (checkpoints, PPSS_CHECKPOINT_COUNT)) != i)
+	continue;
+      states = AREF (checkpoints, PPSS_CHECKPOINT_STATES);
+      if (i == ASIZE (states))
+	{
+	  states = larger_vector (states, 1, -1);
+	  ASET (checkpoints, PPSS_CHECKPOINT_STATES, states);
+	}
+      ASET (states, i, externalize_parse_state (state));
+      ASET (checkpoints, PPSS_CHECKPOINT_COUNT, make_fixnum (i + 1));
+      current_buffer->text->ppss_checkpoints_end
+	= max (current_buffer->text->ppss_checkpoints_end, start);
+    }
+
+  scan_sexps_forward (state, state->location, state->location_byte, to,
+		      target, false, 0);
+}
+
+DEFUN ("syntax-ppss--parse", Fsyntax_ppss__parse, Ssyntax_ppss__parse,
+       1, 1, 0,
+       doc: /* Return the parse state at POS, parsing from the beginning of the buffer.
+The value is like that of `parse-partial-sexp' called from the
+beginning of the buffer to POS, except that the elements 2 and 6
+cannot be relied upon.  Point is moved to POS.
+
+The states at regular intervals are remembered, and each call parses
+from the nearest of them before POS.  They are discarded when the text
+changes, and when `syntax-ppss--flush' is called.  The buffer must not
+be narrowed.  This is an internal function used by `syntax-ppss'.  */)
+  (Lisp_Object pos)
+{
+  struct lisp_parse_state state;
+  Lisp_Object from = make_fixnum (BEG);
+
+  if (BEGV != BEG)
+    error ("Buffer is narrowed");
+  validate_region (&from, &pos);
+
+  ppss_checkpoint_parse (XFIXNUM (pos), &state);
+  SET_PT_BOTH (state.location, state.location_byte);
+
+  return externalize_parse_state (&state);
+}
+
+DEFUN ("syntax-ppss--flush", Fsyntax_ppss__flush, Ssyntax_ppss__flush,
+       1, 1, 0,
+       doc: /* Discard the states remembered by `syntax-ppss--parse' after POS.
+This is an internal function used by `syntax-ppss-flush-cache'.  */)
+  (Lisp_Object pos)
+{
+  syntax_ppss_flush_checkpoints (current_buffer, fix_position (pos));
+  return Qnil;
 }
 
 void
@@ -3828,4 +4052,6 @@ syms_of_syntax (void)
   defsubr (&Sscan_sexps);
   defsubr (&Sbackward_prefix_chars);
   defsubr (&Sparse_partial_sexp);
+  defsubr (&Ssyntax_ppss__parse);
+  defsubr (&Ssyntax_ppss__flush);
 }
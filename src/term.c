@@ -247,6 +247,32 @@ tty_reset_terminal_modes (struct terminal *terminal)
     }
 }
 
+/* Begin or end a synchronized update on TTY, if the terminal supports
+   them.  BEGIN_P true means begin one.  While a synchronized update is
+   in progress, the terminal does not repaint the screen, so partially
+   written frames are never seen, and large updates are presented in
+   one go.  */
+
+static void
+tty_sync_update (struct tty_display_info *tty, bool begin_p)
+{
+  if (tty->TS_sync_update)
+    {
+      char *p = tparam (tty->TS_sync_update, NULL, 0,
+			begin_p ? 1 : 2, 0, 0, 0);
+      OUTPUT (tty, p);
+      xfree (p);
+    }
+}
+
+/* Flag the beginning of a display update on a termcap terminal. */
+
+static void
+tty_update_begin (struct frame *f)
+{
+  tty_sync_update (FRAME_TTY (f), true);
+}
+
 /* Flag the end of a display update on a termcap terminal. */
 
 static void
@@ -258,6 +284,7 @@ tty_update_end (struct frame *f)
     tty_show_cursor (tty);
   tty_turn_off_insert (tty);
   tty_background_highlight (tty);
+  tty_sync_update (tty, false);
   fflush (tty->output);
 }
 
@@ -4265,6 +4292,7 @@ set_tty_hooks (struct terminal *terminal)
   terminal->ring_bell_hook = &tty_ring_bell;
   terminal->reset_terminal_modes_hook = &tty_reset_terminal_modes;
   terminal->set_terminal_modes_hook = &tty_set_terminal_modes;
+  terminal->update_begin_hook = &tty_update_begin;
   terminal->update_end_hook = &tty_update_end;
 #ifdef MSDOS
   terminal->menu_show_hook = &x_menu_show;
@@ -4633,6 +4661,14 @@ init_tty (const char *name, const char *terminal_type, bool must_succeed)
        Requires a single parameter, the color index.  */
     tty->TF_set_underline_color = "\x1b[58:2::%p1%{65536}%/%d:%p1%{256}%/%{255}%&%d:%p1%{255}%&%dm";
 
+  /* Synchronized updates.  This is a terminfo extension, with no
+     termcap equivalent.  */
+#ifdef TERMINFO
+  tty->TS_sync_update = tigetstr ("Sync");
+  if (tty->TS_sync_update == (char *) (intptr_t) -1)
+    tty->TS_sync_update = NULL;
+#endif
+
 #else /* DOS_NT */
 #ifdef WINDOWSNT
   {
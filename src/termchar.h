@@ -178,6 +178,9 @@ #define EMACS_TERMCHAR_H
   const char *TF_set_underline_color; /* Enabled when TF_set_underline_style is set:
                                          Sets the color of the underline.  Accepts a
                                          single parameter, the color index.  */
+  const char *TS_sync_update;	/* terminfo Sync extension: begin (param 1)
+				   or end (param 2) a synchronized update,
+				   which the terminal displays atomically.  */
 
   int RPov;                     /* # chars to start a TS_repeat */
 
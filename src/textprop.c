@@ -1164,6 +1164,45 @@ DEFUN ("previous-single-property-change", Fprevious_single_property_change,
     return make_fixnum (previous->position + LENGTH (previous));
 }
 
+/* Add PROPERTIES to the LEN characters of OBJECT starting at the
+   beginning of interval I, splitting the last interval if necessary.
+   This does not run any hooks.  Return true if any property changed.  */
+
+static bool
+add_properties_from_interval (INTERVAL i, ptrdiff_t len,
+			      Lisp_Object properties, Lisp_Object object,
+			      enum property_set_type set_type,
+			      bool destructive)
+{
+  bool modified = false;
+
+  for (;;)
+    {
+      eassert (i != 0);
+
+      if (LENGTH (i) >= len)
+	{
+	  if (interval_has_all_properties (properties, i))
+	    return modified;
+
+	  if (LENGTH (i) > len)
+	    {
+	      /* I doesn't have the properties, and goes past the
+		 change limit.  */
+	      INTERVAL unchanged = i;
+	      i = split_interval_left (unchanged, len);
+	      copy_properties (unchanged, i);
+	    }
+	  add_properties (properties, i, object, set_type, destructive);
+	  return true;
+	}
+
+      len -= LENGTH (i);
+      modified |= add_properties (properties, i, object, set_type, destructive);
+      i = next_interval (i);
+    }
+}
+
 /* Used by add-text-properties and add-face-text-property. */
 
 static Lisp_Object
@@ -1186,7 +1225,6 @@ add_text_properties_1 (Lisp_Object start, Lisp_Object end,
 
   INTERVAL i, unchanged;
   ptrdiff_t s, len;
-  bool modified = false;
   bool first_time = true;
 
   properties = validate_plist (properties);
@@ -1248,47 +1286,12 @@ add_text_properties_1 (Lisp_Object start, Lisp_Object end,
 	}
     }
 
-  /* We are at the beginning of interval I, with LEN chars to scan.  */
-  for (;;)
-    {
-      eassert (i != 0);
-
-      if (LENGTH (i) >= len)
-	{
-	  if (interval_has_all_properties (properties, i))
-	    {
-	      if (BUFFERP (object))
-		signal_after_change (XFIXNUM (start), XFIXNUM (end) - XFIXNUM (start),
-				     XFIXNUM (end) - XFIXNUM (start));
-
-	      eassert (modified);
-	      return Qt;
-	    }
-
-	  if (LENGTH (i) == len)
-	    {
-	      add_properties (properties, i, object, set_type, destructive);
-	      if (BUFFERP (object))
-		signal_after_change (XFIXNUM (start), XFIXNUM (end) - XFIXNUM (start),
-				     XFIXNUM (end) - XFIXNUM (start));
-	      return Qt;
-	    }
-
-	  /* i doesn't have the properties, and goes past the change limit */
-	  unchanged = i;
-	  i = split_interval_left (unchanged, len);
-	  copy_properties (unchanged, i);
-	  add_properties (properties, i, object, set_type, destructive);
-	  if (BUFFERP (object))
-	    signal_after_change (XFIXNUM (start), XFIXNUM (end) - XFIXNUM (start),
-				 XFIXNUM (end) - XFIXNUM (start));
-	  return Qt;
-	}
-
-      len -= LENGTH (i);
-      modified |= add_properties (properties, i, object, set_type, destructive);
-      i = next_interval (i);
-    }
+  add_properties_from_interval (i, len, properties, object,
+				set_type, destructive);
+  if (BUFFERP (object))
+    signal_after_change (XFIXNUM (start), XFIXNUM (end) - XFIXNUM (start),
+			 XFIXNUM (end) - XFIXNUM (start));
+  return Qt;
 }
 
 /* Callers note, this can GC when OBJECT is a buffer (or nil).  */
@@ -1327,6 +1330,176 @@ DEFUN ("put-text-property", Fput_text_property,
   return Qnil;
 }
 
+/* Add PROPERTIES to the text of OBJECT from START to END, without
+   running any hooks.  Return true if any property changed.  */
+
+static bool
+add_properties_in_range (ptrdiff_t start, ptrdiff_t end,
+			 Lisp_Object properties, Lisp_Object object)
+{
+  Lisp_Object beg = make_fixnum (start), fin = make_fixnum (end);
+  INTERVAL i = validate_interval_range (object, &beg, &fin, hard);
+  ptrdiff_t len = end - start;
+
+  if (!i)
+    return false;
+
+  /* Skip the intervals that already have the properties.  */
+  if (interval_has_all_properties (properties, i))
+    {
+      ptrdiff_t got = LENGTH (i) - (start - i->position);
+
+      do
+	{
+	  if (got >= len)
+	    return false;
+	  len -= got;
+	  i = next_interval (i);
+	  got = LENGTH (i);
+	}
+      while (interval_has_all_properties (properties, i));
+    }
+  else if (i->position != start)
+    {
+      INTERVAL unchanged = i;
+      i = split_interval_right (unchanged, start - unchanged->position);
+      copy_properties (unchanged, i);
+    }
+
+  return add_properties_from_interval (i, len, properties, object,
+				       TEXT_PROPERTY_REPLACE, true);
+}
+
+/* Return the validated bounds of the text property run RUN, an element
+   of the RUNS argument of put-text-property-runs, in *START and *END.
+   Return the interval containing *START, or NULL if OBJECT has no
+   intervals and FORCE is soft.  Signal an error if RUN starts before
+   PREV_END.  */
+
+static INTERVAL
+validate_property_run (Lisp_Object run, Lisp_Object object, bool force,
+		       ptrdiff_t prev_end, ptrdiff_t *start, ptrdiff_t *end)
+{
+  Lisp_Object beg = Fcar (run), fin = Fcar (Fcdr (run));
+  INTERVAL i = validate_interval_range (object, &beg, &fin, force);
+
+  *start = XFIXNUM (beg);
+  *end = XFIXNUM (fin);
+  if (*start < prev_end)
+    error ("Text property runs overlap or are not sorted");
+  return i;
+}
+
+/* Callers note, this can GC when OBJECT is a buffer (or nil).  */
+
+DEFUN ("put-text-property-runs", Fput_text_property_runs,
+       Sput_text_property_runs, 2, 3, 0,
+       doc: /* Set one property on several runs of text.
+RUNS is a list of elements (START END VALUE), sorted by START and not
+overlapping; the property PROPERTY of the text from START to END is
+set to VALUE.
+If the optional third argument OBJECT is a buffer (or nil, which means
+the current buffer), START and END are buffer positions (integers or
+markers).  If OBJECT is a string, START and END are 0-based indices
+into it.
+
+This has the same effect as calling `put-text-property' for each
+element of RUNS, but runs the modification hooks only once, for the
+text from the first START to the last END.
+Return t if any property value actually changed, nil otherwise.  */)
+  (Lisp_Object property, Lisp_Object runs, Lisp_Object object)
+{
+  if (NILP (object))
+    XSETBUFFER (object, current_buffer);
+
+  /* Ensure we run the modification hooks for the right buffer, as in
+     add_text_properties_1.  */
+  if (BUFFERP (object) && XBUFFER (object) != current_buffer)
+    {
+      specpdl_ref count = SPECPDL_INDEX ();
+      record_unwind_current_buffer ();
+      set_buffer_internal (XBUFFER (object));
+      return unbind_to (count, Fput_text_property_runs (property, runs,
+							 object));
+    }
+
+  ptrdiff_t first = 0, last = 0, s, e;
+  bool changes = false;
+
+  /* Check the runs, and find out whether any of them changes
+     anything, before running the hooks.  */
+  Lisp_Object tail = runs;
+  FOR_EACH_TAIL (tail)
+    {
+      Lisp_Object run = XCAR (tail);
+      INTERVAL i = validate_property_run (run, object, soft, last, &s, &e);
+
+      if (EQ (tail, runs))
+	first = s;
+      last = e;
+      if (s == e || changes)
+	continue;
+      if (!i)
+	{
+	  changes = true;
+	  continue;
+	}
+
+      AUTO_LIST2 (properties, property, Fcar (Fcdr (Fcdr (run))));
+      for (ptrdiff_t pos = s; pos < e; i = next_interval (i))
+	{
+	  if (!interval_has_all_properties (properties, i))
+	    {
+	      changes = true;
+	      break;
+	    }
+	  pos = i->position + LENGTH (i);
+	}
+    }
+  CHECK_LIST_END (tail, runs);
+
+  if (!changes)
+    return Qnil;
+
+  if (BUFFERP (object))
+    modify_text_properties (object, make_fixnum (first), make_fixnum (last));
+
+  /* Apply the runs, coalescing adjacent runs with the same value.
+     The hooks may have changed the text, so validate the runs again.  */
+  bool modified = false;
+  ptrdiff_t prev_end = 0;
+  for (tail = runs; CONSP (tail); )
+    {
+      validate_property_run (XCAR (tail), object, hard, prev_end, &s, &e);
+      Lisp_Object value = Fcar (Fcdr (Fcdr (XCAR (tail))));
+      prev_end = e;
+
+      for (tail = XCDR (tail); CONSP (tail); tail = XCDR (tail))
+	{
+	  Lisp_Object next = XCAR (tail);
+	  ptrdiff_t ns, ne;
+
+	  if (!EQ (Fcar (Fcdr (Fcdr (next))), value))
+	    break;
+	  validate_property_run (next, object, hard, prev_end, &ns, &ne);
+	  if (ns != e)
+	    break;
+	  e = prev_end = ne;
+	}
+
+      if (s == e)
+	continue;
+
+      AUTO_LIST2 (properties, property, value);
+      modified |= add_properties_in_range (s, e, properties, object);
+    }
+
+  if (BUFFERP (object))
+    signal_after_change (first, last - first, last - first);
+
+  return modified ? Qt : Qnil;
+}
+
 DEFUN ("set-text-properties", Fset_text_properties,
        Sset_text_properties, 3, 4, 0,
        doc: /* Completely replace properties of text from START to END.
@@ -2468,6 +2641,7 @@ syms_of_textprop (void)
   defsubr (&Sprevious_single_property_change);
   defsubr (&Sadd_text_properties);
   defsubr (&Sput_text_property);
+  defsubr (&Sput_text_property_runs);
   defsubr (&Sset_text_properties);
   defsubr (&Sadd_face_text_property);
   defsubr (&Sremove_text_properties);
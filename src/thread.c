@@ -1234,6 +1234,16 @@ main_thread_p (const void *ptr)
   return ptr == &main_thread.s;
 }
 
+/* Return true if the calling thread is the main thread.  Unlike
+   in_current_thread, this can be called from threads that don't hold
+   the global lock.  */
+
+bool
+in_main_thread (void)
+{
+  return sys_thread_equal (sys_thread_self (), main_thread.s.thread_id);
+}
+
 bool
 in_current_thread (void)
 {
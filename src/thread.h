@@ -331,6 +331,7 @@ XCONDVAR (Lisp_Object a)
 extern void syms_of_threads (void);
 extern bool main_thread_p (const void *);
 extern bool in_current_thread (void);
+extern bool in_main_thread (void);
 
 typedef int select_func (int, fd_set *, fd_set *, fd_set *,
 			 const struct timespec *, const sigset_t *);
@@ -20,6 +20,9 @@ Copyright (C) 2021-2025 Free Software Foundation, Inc.
 along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.  */
 
 #include <config.h>
+
+#include <stdlib.h>
+
 #include "lisp.h"
 #include "buffer.h"
 #include "coding.h"
@@ -35,6 +38,7 @@ Copyright (C) 2021-2025 Free Software Foundation, Inc.
 # include "w32common.h"
 
 /* In alphabetical order.  */
+#undef ts_language_symbol_count
 #undef ts_language_version
 #undef ts_node_child
 #undef ts_node_child_by_field_name
@@ -57,14 +61,18 @@ Copyright (C) 2021-2025 Free Software Foundation, Inc.
 #undef ts_node_prev_sibling
 #undef ts_node_start_byte
 #undef ts_node_string
+#undef ts_node_symbol
 #undef ts_node_type
 #undef ts_parser_delete
 #undef ts_parser_included_ranges
 #undef ts_parser_language
 #undef ts_parser_new
 #undef ts_parser_parse
+#undef ts_parser_parse_string
+#undef ts_parser_set_cancellation_flag
 #undef ts_parser_set_included_ranges
 #undef ts_parser_set_language
+#undef ts_query_capture_count
 #undef ts_query_capture_name_for_id
 #undef ts_query_cursor_delete
 #undef ts_query_cursor_exec
@@ -77,6 +85,7 @@ Copyright (C) 2021-2025 Free Software Foundation, Inc.
 #undef ts_query_predicates_for_pattern
 #undef ts_query_string_value_for_id
 #undef ts_set_allocator
+#undef ts_tree_copy
 #undef ts_tree_cursor_copy
 #undef ts_tree_cursor_current_node
 #undef ts_tree_cursor_delete
@@ -90,6 +99,7 @@ Copyright (C) 2021-2025 Free Software Foundation, Inc.
 #undef ts_tree_get_changed_ranges
 #undef ts_tree_root_node
 
+DEF_DLL_FN (uint32_t, ts_language_symbol_count, (const TSLanguage *));
 DEF_DLL_FN (uint32_t, ts_language_version, (const TSLanguage *));
 DEF_DLL_FN (TSNode, ts_node_child, (TSNode, uint32_t));
 DEF_DLL_FN (TSNode, ts_node_child_by_field_name,
@@ -115,6 +125,7 @@ DEF_DLL_FN (TSNode, ts_node_prev_named_sibling, (TSNode));
 DEF_DLL_FN (TSNode, ts_node_prev_sibling, (TSNode));
 DEF_DLL_FN (uint32_t, ts_node_start_byte, (TSNode));
 DEF_DLL_FN (char *, ts_node_string, (TSNode));
+DEF_DLL_FN (TSSymbol, ts_node_symbol, (TSNode));
 DEF_DLL_FN (const char *, ts_node_type, (TSNode));
 DEF_DLL_FN (void, ts_parser_delete, (TSParser *));
 DEF_DLL_FN (const TSRange *, ts_parser_included_ranges,
@@ -122,9 +133,14 @@ DEF_DLL_FN (const TSRange *, ts_parser_included_ranges,
 DEF_DLL_FN (const TSLanguage *, ts_parser_language, (const TSParser *));
 DEF_DLL_FN (TSParser *, ts_parser_new, (void));
 DEF_DLL_FN (TSTree *, ts_parser_parse, (TSParser *, const TSTree *, TSInput));
+DEF_DLL_FN (TSTree *, ts_parser_parse_string,
+	    (TSParser *, const TSTree *, const char *, uint32_t));
+DEF_DLL_FN (void, ts_parser_set_cancellation_flag,
+	    (TSParser *, const size_t *));
 DEF_DLL_FN (bool, ts_parser_set_included_ranges,
 	    (TSParser *, const TSRange *, uint32_t));
 DEF_DLL_FN (bool, ts_parser_set_language, (TSParser *, const TSLanguage *));
+DEF_DLL_FN (uint32_t, ts_query_capture_count, (const TSQuery *));
 DEF_DLL_FN (const char *, ts_query_capture_name_for_id,
 	    (const TSQuery *, uint32_t, uint32_t *));
 DEF_DLL_FN (void, ts_query_cursor_delete, (TSQueryCursor *));
@@ -145,6 +161,7 @@ DEF_DLL_FN (const char *, ts_query_string_value_for_id,
 	    (const TSQuery *, uint32_t, uint32_t *));
 DEF_DLL_FN (void, ts_set_allocator,
 	    (void *(*)(size_t), void *(*)(size_t, size_t), void *(*)(void *, size_t), void (*)(void *)));
+DEF_DLL_FN (TSTree *, ts_tree_copy, (const TSTree *));
 DEF_DLL_FN (TSTreeCursor, ts_tree_cursor_copy, (const TSTreeCursor *));
 DEF_DLL_FN (TSNode, ts_tree_cursor_current_node, (const TSTreeCursor *));
 DEF_DLL_FN (void, ts_tree_cursor_delete, (const TSTreeCursor *));
@@ -167,6 +184,7 @@ init_treesit_functions (void)
   if (!library)
     return false;
 
+  LOAD_DLL_FN (library, ts_language_symbol_count);
   LOAD_DLL_FN (library, ts_language_version);
   LOAD_DLL_FN (library, ts_node_child);
   LOAD_DLL_FN (library, ts_node_child_by_field_name);
@@ -189,14 +207,18 @@ init_treesit_functions (void)
   LOAD_DLL_FN (library, ts_node_prev_sibling);
   LOAD_DLL_FN (library, ts_node_start_byte);
   LOAD_DLL_FN (library, ts_node_string);
+  LOAD_DLL_FN (library, ts_node_symbol);
   LOAD_DLL_FN (library, ts_node_type);
   LOAD_DLL_FN (library, ts_parser_delete);
   LOAD_DLL_FN (library, ts_parser_included_ranges);
   LOAD_DLL_FN (library, ts_parser_language);
   LOAD_DLL_FN (library, ts_parser_new);
   LOAD_DLL_FN (library, ts_parser_parse);
+  LOAD_DLL_FN (library, ts_parser_parse_string);
+  LOAD_DLL_FN (library, ts_parser_set_cancellation_flag);
   LOAD_DLL_FN (library, ts_parser_set_included_ranges);
   LOAD_DLL_FN (library, ts_parser_set_language);
+  LOAD_DLL_FN (library, ts_query_capture_count);
   LOAD_DLL_FN (library, ts_query_capture_name_for_id);
   LOAD_DLL_FN (library, ts_query_cursor_delete);
   LOAD_DLL_FN (library, ts_query_cursor_exec);
@@ -209,6 +231,7 @@ init_treesit_functions (void)
   LOAD_DLL_FN (library, ts_query_predicates_for_pattern);
   LOAD_DLL_FN (library, ts_query_string_value_for_id);
   LOAD_DLL_FN (library, ts_set_allocator);
+  LOAD_DLL_FN (library, ts_tree_copy);
   LOAD_DLL_FN (library, ts_tree_cursor_copy);
   LOAD_DLL_FN (library, ts_tree_cursor_current_node);
   LOAD_DLL_FN (library, ts_tree_cursor_delete);
@@ -225,6 +248,7 @@ init_treesit_functions (void)
   return true;
 }
 
+#define ts_language_symbol_count fn_ts_language_symbol_count
 #define ts_language_version fn_ts_language_version
 #define ts_node_child fn_ts_node_child
 #define ts_node_child_by_field_name fn_ts_node_child_by_field_name
@@ -247,14 +271,18 @@ #define ts_node_prev_named_sibling fn_ts_node_prev_named_sibling
 #define ts_node_prev_sibling fn_ts_node_prev_sibling
 #define ts_node_start_byte fn_ts_node_start_byte
 #define ts_node_string fn_ts_node_string
+#define ts_node_symbol fn_ts_node_symbol
 #define ts_node_type fn_ts_node_type
 #define ts_parser_delete fn_ts_parser_delete
 #define ts_parser_included_ranges fn_ts_parser_included_ranges
 #define ts_parser_language fn_ts_parser_language
 #define ts_parser_new fn_ts_parser_new
 #define ts_parser_parse fn_ts_parser_parse
+#define ts_parser_parse_string fn_ts_parser_parse_string
+#define ts_parser_set_cancellation_flag fn_ts_parser_set_cancellation_flag
 #define ts_parser_set_included_ranges fn_ts_parser_set_included_ranges
 #define ts_parser_set_language fn_ts_parser_set_language
+#define ts_query_capture_count fn_ts_query_capture_count
 #define ts_query_capture_name_for_id fn_ts_query_capture_name_for_id
 #define ts_query_cursor_delete fn_ts_query_cursor_delete
 #define ts_query_cursor_exec fn_ts_query_cursor_exec
@@ -267,6 +295,7 @@ #define ts_query_pattern_count fn_ts_query_pattern_count
 #define ts_query_predicates_for_pattern fn_ts_query_predicates_for_pattern
 #define ts_query_string_value_for_id fn_ts_query_string_value_for_id
 #define ts_set_allocator fn_ts_set_allocator
+#define ts_tree_copy fn_ts_tree_copy
 #define ts_tree_cursor_copy fn_ts_tree_cursor_copy
 #define ts_tree_cursor_current_node fn_ts_tree_cursor_current_node
 #define ts_tree_cursor_delete fn_ts_tree_cursor_delete
@@ -527,10 +556,54 @@ load_tree_sitter_if_necessary (bool required)
 #endif
 }
 
+/* Tree-sitter allocates through the functions below.  Only a thread
+   that holds the global lock may use xmalloc and friends, whose
+   failure longjmps to the command loop.  The main thread uses them; a
+   background parse (see treesit_async_parse_run) uses plain malloc
+   instead, and aborts like tree-sitter's own allocator when memory
+   runs out.  So do other Lisp threads, since current_thread cannot be
+   read safely from a worker.  Memory from either can be freed by the
+   other, since xfree calls free.  */
+
+static void *
+treesit_check_alloc (void *ptr)
+{
+  if (!ptr)
+    emacs_abort ();
+  return ptr;
+}
+
+static void *
+treesit_malloc_wrapper (size_t size)
+{
+  if (in_main_thread ())
+    return xmalloc (size);
+  return treesit_check_alloc (malloc (size));
+}
+
 static void *
 treesit_calloc_wrapper (size_t n, size_t size)
 {
-  return xzalloc (n * size);
+  if (in_main_thread ())
+    return xzalloc (n * size);
+  return treesit_check_alloc (calloc (n, size));
+}
+
+static void *
+treesit_realloc_wrapper (void *ptr, size_t size)
+{
+  if (in_main_thread ())
+    return xrealloc (ptr, size);
+  return treesit_check_alloc (realloc (ptr, size));
+}
+
+static void
+treesit_free_wrapper (void *ptr)
+{
+  if (in_main_thread ())
+    xfree (ptr);
+  else
+    free (ptr);
 }
 
 static void
@@ -539,7 +612,8 @@ treesit_initialize (void)
   if (!treesit_initialized)
     {
       load_tree_sitter_if_necessary (true);
-      ts_set_allocator (xmalloc, treesit_calloc_wrapper, xrealloc, xfree);
+      ts_set_allocator (treesit_malloc_wrapper, treesit_calloc_wrapper,
+			treesit_realloc_wrapper, treesit_free_wrapper);
       treesit_initialized = true;
     }
 }
@@ -1321,6 +1395,8 @@ compute_new_linecol_by_change (struct ts_linecol pos_linecol,
    If the current buffer doesn't track linecol, start_linecol,
    old_end_linecol, and new_end_linecol will be empty.  In that case,
    don't process linecols.  */
+static void treesit_async_parse_cancel (struct Lisp_TS_Parser *);
+
 static void
 treesit_record_change_1 (ptrdiff_t start_byte, ptrdiff_t old_end_byte,
 			 ptrdiff_t new_end_byte,
@@ -1340,6 +1416,7 @@ treesit_record_change_1 (ptrdiff_t start_byte, ptrdiff_t old_end_byte,
       CHECK_CONS (parser_list);
       Lisp_Object lisp_parser = XCAR (parser_list);
       treesit_check_parser (lisp_parser);
+      treesit_async_parse_cancel (XTS_PARSER (lisp_parser));
       TSTree *tree = XTS_PARSER (lisp_parser)->tree;
       /* See comment (ref:visible-beg-null) if you wonder why we don't
 	 update visible_beg/end when tree is NULL.  */
@@ -1584,6 +1661,9 @@ treesit_sync_visible_region (Lisp_Object parser)
   the offset acrobatics and updating the tree below.  */
   if (tree == NULL)
     {
+      if (XTS_PARSER (parser)->visible_beg != BUF_BEGV_BYTE (buffer)
+	  || XTS_PARSER (parser)->visible_end != BUF_ZV_BYTE (buffer))
+	treesit_async_parse_cancel (XTS_PARSER (parser));
       XTS_PARSER (parser)->visible_beg = BUF_BEGV_BYTE (buffer);
       XTS_PARSER (parser)->visible_end = BUF_ZV_BYTE (buffer);
       return;
@@ -1602,7 +1682,10 @@ treesit_sync_visible_region (Lisp_Object parser)
      this function is called), we need to reparse.  */
   if (visible_beg != BUF_BEGV_BYTE (buffer)
       || visible_end != BUF_ZV_BYTE (buffer))
-    XTS_PARSER (parser)->need_reparse = true;
+    {
+      XTS_PARSER (parser)->need_reparse = true;
+      treesit_async_parse_cancel (XTS_PARSER (parser));
+    }
 
   /* Before we parse or set ranges, catch up with the narrowing
      situation.  We change visible_beg and visible_end to match
@@ -1842,6 +1925,204 @@ treesit_call_after_change_functions (Lisp_Object parser, Lisp_Object ranges)
   unbind_to (count, Qnil);
 }
 
+/*** Background parsing  */
+
+/* A parse running on a worker thread, started by
+   treesit-parser-parse-in-background.  The worker parses a private
+   copy of the visible portion of the buffer with its own TSParser,
+   starting from a copy of the old tree (tree-sitter trees must be
+   copied to be used by two threads), so it never touches Lisp data or
+   the buffer.  DONE and NEW_TREE are protected by
+   treesit_async_mutex.  */
+struct treesit_async_parse
+{
+  /* The parser used by the worker thread.  It has the same language
+     and included ranges as the Lisp parser had when the parse
+     started.  */
+  TSParser *parser;
+  /* A copy of the Lisp parser's tree, or NULL for a first parse.  */
+  TSTree *old_tree;
+  /* The snapshot of the visible portion of the buffer.  */
+  char *text;
+  uint32_t nbytes;
+  /* Tree-sitter polls this flag while parsing, and gives up when it
+     is non-zero.  We set it as soon as the snapshot goes stale,
+     i.e. when the buffer text, the visible region or the ranges of
+     the Lisp parser change.  Since the worker reads it, access it only
+     through treesit_async_parse_cancel and
+     treesit_async_parse_canceled_p.  */
+  size_t cancel;
+  /* Whether the worker has finished.  */
+  bool done;
+  /* The tree produced by the worker, or NULL if it was canceled.  */
+  TSTree *new_tree;
+};
+
+static sys_mutex_t treesit_async_mutex;
+/* Signaled when a worker finishes.  */
+static sys_cond_t treesit_async_cond;
+static bool treesit_async_initialized;
+
+/* The parsers that have a background parse, each once, so that the
+   command loop can install their trees between commands.  This list
+   also keeps the parsers alive while their worker runs.  A parser
+   leaves it when its background parse is taken.  */
+static Lisp_Object treesit_async_parsers;
+
+static void *
+treesit_async_parse_run (void *arg)
+{
+  struct treesit_async_parse *job = arg;
+
+  sys_thread_set_name ("treesit-parse");
+  TSTree *new_tree = ts_parser_parse_string (job->parser, job->old_tree,
+					     job->text, job->nbytes);
+
+  sys_mutex_lock (&treesit_async_mutex);
+  job->new_tree = new_tree;
+  job->done = true;
+  sys_cond_broadcast (&treesit_async_cond);
+  sys_mutex_unlock (&treesit_async_mutex);
+  return NULL;
+}
+
+static bool
+treesit_async_parse_done_p (struct treesit_async_parse *job)
+{
+  sys_mutex_lock (&treesit_async_mutex);
+  bool done = job->done;
+  sys_mutex_unlock (&treesit_async_mutex);
+  return done;
+}
+
+/* Mark the background parse of LISP_PARSER, if any, as stale.  This
+   doesn't wait for the worker, so it is cheap enough to call on every
+   buffer change.  */
+static void
+treesit_async_parse_cancel (struct Lisp_TS_Parser *lisp_parser)
+{
+  struct treesit_async_parse *job = lisp_parser->async_parse;
+  if (job)
+    {
+#if GNUC_PREREQ (4, 7, 0)
+      __atomic_store_n (&job->cancel, 1, __ATOMIC_SEQ_CST);
+#else
+      job->cancel = 1;
+#endif
+    }
+}
+
+static bool
+treesit_async_parse_canceled_p (struct treesit_async_parse *job)
+{
+#if GNUC_PREREQ (4, 7, 0)
+  return __atomic_load_n (&job->cancel, __ATOMIC_SEQ_CST) != 0;
+#else
+  return job->cancel != 0;
+#endif
+}
+
+/* Detach the background parse from LISP_PARSER, wait for its worker
+   and return the tree it produced.  Return NULL if there is no
+   background parse or it was canceled.  */
+static TSTree *
+treesit_async_parse_take (struct Lisp_TS_Parser *lisp_parser)
+{
+  struct treesit_async_parse *job = lisp_parser->async_parse;
+  if (job == NULL)
+    return NULL;
+  lisp_parser->async_parse = NULL;
+  treesit_async_parsers = Fdelq (make_lisp_ptr (lisp_parser,
+						 Lisp_Vectorlike),
+				 treesit_async_parsers);
+
+  sys_mutex_lock (&treesit_async_mutex);
+  while (!job->done)
+    sys_cond_wait (&treesit_async_cond, &treesit_async_mutex);
+  sys_mutex_unlock (&treesit_async_mutex);
+
+  TSTree *new_tree = job->new_tree;
+  if (treesit_async_parse_canceled_p (job))
+    {
+      ts_tree_delete (new_tree);
+      new_tree = NULL;
+    }
+  ts_tree_delete (job->old_tree);
+  ts_parser_delete (job->parser);
+  xfree (job->text);
+  xfree (job);
+  return new_tree;
+}
+
+/* Drop the finished background parses of parsers that were deleted
+   or whose buffer was killed, so that they don't stay alive when the
+   command loop doesn't run, as in batch mode.  */
+static void
+treesit_async_parse_prune (void)
+{
+  Lisp_Object tail = Fcopy_sequence (treesit_async_parsers);
+  FOR_EACH_TAIL_SAFE (tail)
+    {
+      struct Lisp_TS_Parser *lisp_parser = XTS_PARSER (XCAR (tail));
+      if ((lisp_parser->deleted
+	   || !BUFFER_LIVE_P (XBUFFER (lisp_parser->buffer)))
+	  && treesit_async_parse_done_p (lisp_parser->async_parse))
+	ts_tree_delete (treesit_async_parse_take (lisp_parser));
+    }
+}
+
+/* Start parsing the visible portion of BUFFER for PARSER on a worker
+   thread.  PARSER's visible region must be in sync with BUFFER.
+   Return true if the worker was started.  */
+static bool
+treesit_async_parse_start (Lisp_Object parser, struct buffer *buffer)
+{
+  struct Lisp_TS_Parser *lisp_parser = XTS_PARSER (parser);
+  eassert (lisp_parser->async_parse == NULL);
+
+  if (!treesit_async_initialized)
+    {
+      sys_mutex_init (&treesit_async_mutex);
+      sys_cond_init (&treesit_async_cond);
+      treesit_async_initialized = true;
+    }
+  treesit_async_parse_prune ();
+
+  struct treesit_async_parse *job = xzalloc (sizeof *job);
+  job->parser = ts_parser_new ();
+  ts_parser_set_language (job->parser,
+			  ts_parser_language (lisp_parser->parser));
+  uint32_t nranges;
+  const TSRange *ranges
+    = ts_parser_included_ranges (lisp_parser->parser, &nranges);
+  ts_parser_set_included_ranges (job->parser, ranges, nranges);
+  ts_parser_set_cancellation_flag (job->parser, &job->cancel);
+  if (lisp_parser->tree)
+    job->old_tree = ts_tree_copy (lisp_parser->tree);
+
+  /* Copy the text around the gap.  */
+  ptrdiff_t beg = lisp_parser->visible_beg;
+  ptrdiff_t end = lisp_parser->visible_end;
+  ptrdiff_t gpt = clip_to_bounds (beg, BUF_GPT_BYTE (buffer), end);
+  job->nbytes = end - beg;
+  job->text = xmalloc (job->nbytes + 1);
+  memcpy (job->text, BUF_BYTE_ADDRESS (buffer, beg), gpt - beg);
+  memcpy (job->text + (gpt - beg), BUF_BYTE_ADDRESS (buffer, gpt),
+	  end - gpt);
+
+  sys_thread_t thread;
+  lisp_parser->async_parse = job;
+  if (!sys_thread_create (&thread, treesit_async_parse_run, job))
+    {
+      job->done = true;
+      treesit_async_parse_take (lisp_parser);
+      return false;
+    }
+  treesit_async_parsers = Fcons (parser, treesit_async_parsers);
+  return true;
+}
+
+
 /* Parse the buffer.  We don't parse until we have to.  When we have to,
    we call this function to parse and update the tree.  Return the
    affected ranges (a list of (BEG . END)).  If reparse didn't happen
@@ -1870,14 +2151,26 @@ treesit_ensure_parsed (Lisp_Object parser)
   TSTree *tree = XTS_PARSER (parser)->tree;
   TSInput input = XTS_PARSER (parser)->input;
 
-  TSTree *new_tree = ts_parser_parse (treesit_parser, tree, input);
+  /* While a background parse of the current text runs, keep using the
+     old tree, if there is one.  Once it has finished, its result is as
+     good as ours.  */
+  struct treesit_async_parse *job = XTS_PARSER (parser)->async_parse;
+  if (job && tree && !treesit_async_parse_canceled_p (job)
+      && !treesit_async_parse_done_p (job))
+    {
+      XTS_PARSER (parser)->within_reparse = false;
+      return Qnil;
+    }
+  TSTree *new_tree = treesit_async_parse_take (XTS_PARSER (parser));
+  if (new_tree == NULL)
+    new_tree = ts_parser_parse (treesit_parser, tree, input);
   /* This should be very rare (impossible, really): it only happens
      when 1) language is not set (impossible in Emacs because the user
      has to supply a language to create a parser), 2) parse canceled
      due to timeout (impossible because we don't set a timeout), 3)
      parse canceled due to cancellation flag (impossible because we
-     don't set the flag).  (See comments for ts_parser_parse in
-     tree_sitter/api.h.)  */
+     only set the flag on the parsers of background parses).  (See
+     comments for ts_parser_parse in tree_sitter/api.h.)  */
   if (new_tree == NULL)
     {
       Lisp_Object buf;
@@ -1897,6 +2190,40 @@ treesit_ensure_parsed (Lisp_Object parser)
   return ranges;
 }
 
+/* Install the trees of the background parses that finished, so their
+   parsers' after-change functions run between commands rather than
+   whenever Lisp code next asks for a node.  Drop the background parses
+   that went stale.  Called by the command loop.  */
+void
+treesit_install_async_parses (void)
+{
+  /* Taking a parse removes its parser from treesit_async_parsers, and
+     the after-change functions may start other parses, so walk a
+     copy.  */
+  Lisp_Object tail = Fcopy_sequence (treesit_async_parsers);
+
+  FOR_EACH_TAIL_SAFE (tail)
+    {
+      Lisp_Object parser = XCAR (tail);
+      struct Lisp_TS_Parser *lisp_parser = XTS_PARSER (parser);
+      struct treesit_async_parse *job = lisp_parser->async_parse;
+      if (job == NULL || !treesit_async_parse_done_p (job))
+	continue;
+
+      /* Also check the visible region here: if it changed since the
+	 parse started, treesit_ensure_parsed would parse again
+	 synchronously, which is what we want to avoid.  */
+      struct buffer *buffer = XBUFFER (lisp_parser->buffer);
+      if (treesit_async_parse_canceled_p (job)
+	  || lisp_parser->deleted || !BUFFER_LIVE_P (buffer)
+	  || lisp_parser->visible_beg != BUF_BEGV_BYTE (buffer)
+	  || lisp_parser->visible_end != BUF_ZV_BYTE (buffer))
+	ts_tree_delete (treesit_async_parse_take (lisp_parser));
+      else
+	treesit_ensure_parsed (parser);
+    }
+}
+
 /* This is the read function provided to tree-sitter to read from a
    buffer.  It reads one character at a time and automatically skips
    the gap.  */
@@ -1966,7 +2293,7 @@ make_treesit_parser (Lisp_Object buffer, TSParser *parser,
   struct Lisp_TS_Parser *lisp_parser;
 
   lisp_parser = ALLOCATE_PSEUDOVECTOR (struct Lisp_TS_Parser,
-				       buffer, PVEC_TS_PARSER);
+				       node_cache, PVEC_TS_PARSER);
 
   lisp_parser->language_symbol = language_symbol;
   lisp_parser->after_change_functions = Qnil;
@@ -1974,10 +2301,12 @@ make_treesit_parser (Lisp_Object buffer, TSParser *parser,
   lisp_parser->last_set_ranges = Qnil;
   lisp_parser->embed_level = Qnil;
   lisp_parser->buffer = buffer;
+  lisp_parser->node_cache = Qnil;
   lisp_parser->parser = parser;
   lisp_parser->tree = tree;
   TSInput input = {lisp_parser, treesit_read_buffer, TSInputEncodingUTF8};
   lisp_parser->input = input;
+  lisp_parser->async_parse = NULL;
   lisp_parser->need_reparse = true;
   lisp_parser->visible_beg = BUF_BEGV_BYTE (XBUFFER (buffer));
   lisp_parser->visible_end = BUF_ZV_BYTE (XBUFFER (buffer));
@@ -2010,18 +2339,38 @@ make_treesit_parser (Lisp_Object buffer, TSParser *parser,
   return make_lisp_ptr (lisp_parser, Lisp_Vectorlike);
 }
 
-/* Wrap the node in a Lisp_Object to be used in the Lisp machine.  */
+/* The number of slots in the node cache of a parser.  */
+#define TREESIT_NODE_CACHE_SIZE 64
+
+/* Wrap the node in a Lisp_Object to be used in the Lisp machine.
+
+   Nodes are immutable, so if PARSER made a node object for NODE since
+   its last change, and it is still in PARSER's node cache, return
+   that object instead of making a new one.  */
 Lisp_Object
 make_treesit_node (Lisp_Object parser, TSNode node)
 {
+  struct Lisp_TS_Parser *lisp_parser = XTS_PARSER (parser);
+  if (NILP (lisp_parser->node_cache))
+    lisp_parser->node_cache = make_nil_vector (TREESIT_NODE_CACHE_SIZE);
+  ptrdiff_t slot = ((((uintptr_t) node.id >> 4) ^ node.context[0])
+		    % TREESIT_NODE_CACHE_SIZE);
+  Lisp_Object cached = AREF (lisp_parser->node_cache, slot);
+  if (TS_NODEP (cached)
+      && XTS_NODE (cached)->timestamp == lisp_parser->timestamp
+      && memcmp (&XTS_NODE (cached)->node, &node, sizeof node) == 0)
+    return cached;
+
   struct Lisp_TS_Node *lisp_node;
 
   lisp_node = ALLOCATE_PSEUDOVECTOR (struct Lisp_TS_Node,
 				     parser, PVEC_TS_NODE);
   lisp_node->parser = parser;
   lisp_node->node = node;
-  lisp_node->timestamp = XTS_PARSER (parser)->timestamp;
-  return make_lisp_ptr (lisp_node, Lisp_Vectorlike);
+  lisp_node->timestamp = lisp_parser->timestamp;
+  Lisp_Object lisp_obj = make_lisp_ptr (lisp_node, Lisp_Vectorlike);
+  ASET (lisp_parser->node_cache, slot, lisp_obj);
+  return lisp_obj;
 }
 
 /* Make a compiled query.  QUERY has to be either a cons or a
@@ -2032,10 +2381,11 @@ make_treesit_query (Lisp_Object query, Lisp_Object language)
   struct Lisp_TS_Query *lisp_query;
 
   lisp_query = ALLOCATE_PSEUDOVECTOR (struct Lisp_TS_Query,
-				      source, PVEC_TS_COMPILED_QUERY);
+				      predicates, PVEC_TS_COMPILED_QUERY);
 
   lisp_query->language = language;
   lisp_query->source = query;
+  lisp_query->predicates = Qnil;
   lisp_query->query = NULL;
   lisp_query->cursor = NULL;
   return make_lisp_ptr (lisp_query, Lisp_Vectorlike);
@@ -2047,6 +2397,8 @@ treesit_delete_parser (struct Lisp_TS_Parser *lisp_parser)
 {
   if (lisp_parser->need_to_gc_buffer)
     Fkill_buffer (lisp_parser->buffer);
+  treesit_async_parse_cancel (lisp_parser);
+  ts_tree_delete (treesit_async_parse_take (lisp_parser));
   ts_tree_delete (lisp_parser->tree);
   ts_parser_delete (lisp_parser->parser);
 }
@@ -2110,6 +2462,8 @@ treesit_ensure_query_cursor (Lisp_Object query)
   return XTS_COMPILED_QUERY (query)->cursor;
 }
 
+static Lisp_Object treesit_compile_predicates (TSQuery *);
+
 /* Ensure the QUERY is compiled.  Return the TSQuery.  It could be
    NULL if error occurs, in which case ERROR_OFFSET and ERROR_TYPE are
    bound.  If error occurs, return NULL, and assign SIGNAL_SYMBOL and
@@ -2160,6 +2514,9 @@ treesit_ensure_query_compiled (Lisp_Object query, Lisp_Object *signal_symbol,
 							error_type,
 							source);
     }
+  else
+    XTS_COMPILED_QUERY (query)->predicates
+      = treesit_compile_predicates (treesit_query);
   XTS_COMPILED_QUERY (query)->query = treesit_query;
   return treesit_query;
 }
@@ -2369,6 +2726,7 @@ DEFUN ("treesit-parser-delete",
     = Fdelete (parser, BVAR (buf, ts_parser_list));
 
   XTS_PARSER (parser)->deleted = true;
+  treesit_async_parse_cancel (XTS_PARSER (parser));
   return Qnil;
 }
 
@@ -2679,6 +3037,7 @@ DEFUN ("treesit-parser-set-included-ranges",
 	      ranges);
 
   XTS_PARSER (parser)->need_reparse = true;
+  treesit_async_parse_cancel (XTS_PARSER (parser));
   return Qnil;
 }
 
@@ -2815,6 +3174,44 @@ DEFUN ("treesit-parser-changed-regions",
   return treesit_ensure_parsed (parser);
 }
 
+DEFUN ("treesit-parser-parse-in-background",
+       Ftreesit_parser_parse_in_background,
+       Streesit_parser_parse_in_background,
+       1, 1, 0,
+       doc: /* Start re-parsing PARSER's buffer on a background thread.
+
+The background parse works on a copy of the accessible portion of the
+buffer, so Emacs can keep running commands meanwhile.  Any change to the
+buffer text, the accessible portion or PARSER's ranges cancels it.
+Until the background parse finishes, functions that need PARSER's tree
+use the old one; they wait for the background parse only if PARSER has
+no tree yet.  The new tree is installed between commands, or when a
+function needs PARSER's tree after the background parse finished,
+whichever comes first.
+
+Return non-nil if a background parse of PARSER is in progress, nil if
+PARSER doesn't need to re-parse or this Emacs can't parse in the
+background.  */)
+  (Lisp_Object parser)
+{
+  treesit_check_parser (parser);
+  treesit_initialize ();
+
+  struct Lisp_TS_Parser *lisp_parser = XTS_PARSER (parser);
+  if (lisp_parser->async_parse
+      && !treesit_async_parse_canceled_p (lisp_parser->async_parse))
+    return Qt;
+
+  struct buffer *buffer = XBUFFER (lisp_parser->buffer);
+  treesit_check_buffer_size (buffer);
+  treesit_sync_visible_region (parser);
+  if (!lisp_parser->need_reparse)
+    return Qnil;
+
+  ts_tree_delete (treesit_async_parse_take (lisp_parser));
+  return treesit_async_parse_start (parser, buffer) ? Qt : Qnil;
+}
+
 /*** Node API  */
 
 /* Check that OBJ is a positive integer and signal an error if
@@ -3506,7 +3903,11 @@ DEFUN ("treesit-query-expand",
 };
 
 /* Collect predicates for this match and return them in a list.  Each
-   predicate is a list of strings and symbols.  */
+   predicate is a list (NAME ARG...).  NAME is :equal, :match or :pred
+   for the predicates we support, and a string for any other (which
+   treesit_eval_predicates rejects).  Each ARG is a string, or a symbol
+   for a capture name; the function name of :pred is interned
+   here.  */
 static Lisp_Object
 treesit_predicates_for_pattern (TSQuery *query, uint32_t pattern_index)
 {
@@ -3540,7 +3941,23 @@ treesit_predicates_for_pattern (TSQuery *query, uint32_t pattern_index)
 	    break;
 	  }
 	case TSQueryPredicateStepTypeDone:
-	  result = Fcons (Fnreverse (predicate), result);
+	  predicate = Fnreverse (predicate);
+	  if (CONSP (predicate))
+	    {
+	      Lisp_Object name = XCAR (predicate);
+	      Lisp_Object args = XCDR (predicate);
+	      if (!NILP (Fstring_equal (name, Vtreesit_str_equal)))
+		XSETCAR (predicate, QCequal);
+	      else if (!NILP (Fstring_equal (name, Vtreesit_str_match)))
+		XSETCAR (predicate, QCmatch);
+	      else if (!NILP (Fstring_equal (name, Vtreesit_str_pred)))
+		{
+		  XSETCAR (predicate, QCpred);
+		  if (CONSP (args) && STRINGP (XCAR (args)))
+		    XSETCAR (args, Fintern (XCAR (args), Qnil));
+		}
+	    }
+	  result = Fcons (predicate, result);
 	  predicate = Qnil;
 	  break;
 	}
@@ -3548,6 +3965,18 @@ treesit_predicates_for_pattern (TSQuery *query, uint32_t pattern_index)
   return Fnreverse (result);
 }
 
+/* Return a vector of the predicates of each pattern of QUERY, as
+   returned by treesit_predicates_for_pattern.  */
+static Lisp_Object
+treesit_compile_predicates (TSQuery *query)
+{
+  uint32_t patterns_count = ts_query_pattern_count (query);
+  Lisp_Object table = make_nil_vector (patterns_count);
+  for (uint32_t idx = 0; idx < patterns_count; idx++)
+    ASET (table, idx, treesit_predicates_for_pattern (query, idx));
+  return table;
+}
+
 /* Translate a capture NAME (symbol) to a node.  If everything goes
    fine, set NODE and return true; if error occurs (e.g., when there
    is no node for the capture name), set NODE to Qnil, SIGNAL_DATA to
@@ -3580,33 +4009,76 @@ treesit_predicate_capture_name_to_node (Lisp_Object name,
   return true;
 }
 
-/* Translate a capture NAME (symbol) to the text of the captured node.
-   If everything goes fine, set TEXT to the text and return true;
-   otherwise set TEXT to Qnil and set SIGNAL_DATA to a suitable signal
-   data.  */
+/* Set *START and *END to the buffer byte positions spanned by the
+   Lisp NODE.  */
+static void
+treesit_node_byte_span (Lisp_Object node, ptrdiff_t *start, ptrdiff_t *end)
+{
+  TSNode treesit_node = XTS_NODE (node)->node;
+  ptrdiff_t visible_beg = XTS_PARSER (XTS_NODE (node)->parser)->visible_beg;
+  *start = visible_beg + ts_node_start_byte (treesit_node);
+  *end = visible_beg + ts_node_end_byte (treesit_node);
+}
+
+/* Return true if the LEN bytes of BUFFER's text at BYTEPOS are the
+   same as those at P.  */
 static bool
-treesit_predicate_capture_name_to_text (Lisp_Object name,
-					struct capture_range captures,
-					Lisp_Object *text,
-					Lisp_Object *signal_data)
+treesit_buffer_bytes_equal (struct buffer *buffer, ptrdiff_t bytepos,
+			    const unsigned char *p, ptrdiff_t len)
 {
-  Lisp_Object node = Qnil;
-  if (!treesit_predicate_capture_name_to_node (name, captures, &node, signal_data))
-    return false;
+  ptrdiff_t before_gap = clip_to_bounds (0, BUF_GPT_BYTE (buffer) - bytepos,
+					 len);
+  return (memcmp (BUF_BYTE_ADDRESS (buffer, bytepos), p, before_gap) == 0
+	  && memcmp (BUF_BYTE_ADDRESS (buffer, bytepos + before_gap),
+		     p + before_gap, len - before_gap) == 0);
+}
+
+/* Return true if the LEN bytes of BUFFER's text at POS1 are the same
+   as those at POS2.  */
+static bool
+treesit_buffer_spans_equal (struct buffer *buffer, ptrdiff_t pos1,
+			    ptrdiff_t pos2, ptrdiff_t len)
+{
+  ptrdiff_t before_gap = clip_to_bounds (0, BUF_GPT_BYTE (buffer) - pos1,
+					 len);
+  return (treesit_buffer_bytes_equal (buffer, pos2,
+				      BUF_BYTE_ADDRESS (buffer, pos1),
+				      before_gap)
+	  && treesit_buffer_bytes_equal (buffer, pos2 + before_gap,
+					 BUF_BYTE_ADDRESS (buffer,
+							   pos1 + before_gap),
+					 len - before_gap));
+}
+
+/* Return true if the text spanned by NODE in BUFFER equals STRING.
+   Compare bytes in place when the representations agree; otherwise
+   fall back to comparing strings.  */
+static bool
+treesit_node_text_equal (struct buffer *buffer, Lisp_Object node,
+			 Lisp_Object string)
+{
+  ptrdiff_t start, end;
+  treesit_node_byte_span (node, &start, &end);
+  if (!NILP (BVAR (buffer, enable_multibyte_characters))
+      && (STRING_MULTIBYTE (string) || SCHARS (string) == SBYTES (string)))
+    return (end - start == SBYTES (string)
+	    && treesit_buffer_bytes_equal (buffer, start, SDATA (string),
+					   end - start));
 
   struct buffer *old_buffer = current_buffer;
-  set_buffer_internal (XBUFFER (XTS_PARSER (XTS_NODE (node)->parser)->buffer));
-  *text = Fbuffer_substring (Ftreesit_node_start (node),
-			     Ftreesit_node_end (node));
+  set_buffer_internal (buffer);
+  Lisp_Object text = Fbuffer_substring (Ftreesit_node_start (node),
+					Ftreesit_node_end (node));
   set_buffer_internal (old_buffer);
-  return true;
+  return !NILP (Fstring_equal (text, string));
 }
 
 /* Handles predicate (#equal A B).  Return true if A equals B; return
    false otherwise.  A and B can be either string, or a capture name.
    The capture name evaluates to the text its captured node spans in
-   the buffer.  If everything goes fine, don't touch SIGNAL_DATA; if
-   error occurs, set it to a suitable signal data.  */
+   the buffer, which is compared in place rather than copied to a
+   string.  If everything goes fine, don't touch SIGNAL_DATA; if error
+   occurs, set it to a suitable signal data.  */
 static bool
 treesit_predicate_equal (Lisp_Object args, struct capture_range captures,
 			 Lisp_Object *signal_data)
@@ -3620,22 +4092,34 @@ treesit_predicate_equal (Lisp_Object args, struct capture_range captures,
     }
   Lisp_Object arg1 = XCAR (args);
   Lisp_Object arg2 = XCAR (XCDR (args));
-  Lisp_Object text1 = arg1;
-  Lisp_Object text2 = arg2;
-  if (SYMBOLP (arg1))
-    {
-      if (!treesit_predicate_capture_name_to_text (arg1, captures, &text1,
-						   signal_data))
-	return false;
-    }
-  if (SYMBOLP (arg2))
-    {
-      if (!treesit_predicate_capture_name_to_text (arg2, captures, &text2,
-						   signal_data))
-	return false;
-    }
+  Lisp_Object node1 = Qnil;
+  Lisp_Object node2 = Qnil;
+  if (SYMBOLP (arg1)
+      && !treesit_predicate_capture_name_to_node (arg1, captures, &node1,
+						  signal_data))
+    return false;
+  if (SYMBOLP (arg2)
+      && !treesit_predicate_capture_name_to_node (arg2, captures, &node2,
+						  signal_data))
+    return false;
+
+  if (NILP (node1) && NILP (node2))
+    return !NILP (Fstring_equal (arg1, arg2));
+
+  struct buffer *buffer
+    = XBUFFER (XTS_PARSER (XTS_NODE (NILP (node1) ? node2 : node1)
+			   ->parser)->buffer);
+  if (NILP (node1))
+    return treesit_node_text_equal (buffer, node2, arg1);
+  if (NILP (node2))
+    return treesit_node_text_equal (buffer, node1, arg2);
 
-  return !NILP (Fstring_equal (text1, text2));
+  ptrdiff_t start1, end1, start2, end2;
+  treesit_node_byte_span (node1, &start1, &end1);
+  treesit_node_byte_span (node2, &start2, &end2);
+  return (end1 - start1 == end2 - start2
+	  && treesit_buffer_spans_equal (buffer, start1, start2,
+					 end1 - start1));
 }
 
 /* Handles predicate (#match "regexp" @node).  Return true if "regexp"
@@ -3674,12 +4158,8 @@ treesit_predicate_match (Lisp_Object args, struct capture_range captures,
 					       signal_data))
     return false;
 
-  TSNode treesit_node = XTS_NODE (node)->node;
-  ptrdiff_t visible_beg = XTS_PARSER (XTS_NODE (node)->parser)->visible_beg;
-  uint32_t start_byte_offset = ts_node_start_byte (treesit_node);
-  uint32_t end_byte_offset = ts_node_end_byte (treesit_node);
-  ptrdiff_t start_byte = visible_beg + start_byte_offset;
-  ptrdiff_t end_byte = visible_beg + end_byte_offset;
+  ptrdiff_t start_byte, end_byte;
+  treesit_node_byte_span (node, &start_byte, &end_byte);
   ptrdiff_t start_pos = BYTE_TO_CHAR (start_byte);
   ptrdiff_t end_pos = BYTE_TO_CHAR (end_byte);
   ptrdiff_t old_begv = BEGV;
@@ -3720,7 +4200,8 @@ treesit_predicate_pred (Lisp_Object args, struct capture_range captures,
       return false;
     }
 
-  Lisp_Object fn = Fintern (XCAR (args), Qnil);
+  /* treesit_predicates_for_pattern already interned the name.  */
+  Lisp_Object fn = XCAR (args);
   Lisp_Object nodes = Qnil;
   Lisp_Object tail = XCDR (args);
   FOR_EACH_TAIL (tail)
@@ -3751,11 +4232,11 @@ treesit_eval_predicates (struct capture_range captures, Lisp_Object predicates,
       Lisp_Object predicate = XCAR (tail);
       Lisp_Object fn = XCAR (predicate);
       Lisp_Object args = XCDR (predicate);
-      if (!NILP (Fstring_equal (fn, Vtreesit_str_equal)))
+      if (EQ (fn, QCequal))
 	pass &= treesit_predicate_equal (args, captures, signal_data);
-      else if (!NILP (Fstring_equal (fn, Vtreesit_str_match)))
+      else if (EQ (fn, QCmatch))
 	pass &= treesit_predicate_match (args, captures, signal_data);
-      else if (!NILP (Fstring_equal (fn, Vtreesit_str_pred)))
+      else if (EQ (fn, QCpred))
 	pass &= treesit_predicate_pred (args, captures, signal_data);
       else
 	{
@@ -4015,7 +4496,11 @@ DEFUN ("treesit-query-capture",
   uint32_t patterns_count = ts_query_pattern_count (treesit_query);
   Lisp_Object result = Qnil;
   Lisp_Object prev_result = result;
-  Lisp_Object predicates_table = make_vector (patterns_count, Qt);
+  /* A compiled query has its predicates compiled along with it;
+     otherwise compile them as we need them.  */
+  Lisp_Object predicates_table
+    = (TS_COMPILED_QUERY_P (query) ? XTS_COMPILED_QUERY (query)->predicates
+       : make_vector (patterns_count, Qt));
   Lisp_Object predicate_signal_data = Qnil;
 
   struct buffer *old_buf = current_buffer;
@@ -4114,6 +4599,218 @@ DEFUN ("treesit-query-capture",
   return Fnreverse (result);
 }
 
+/* A capture collected by treesit--query-fontify.  NAME is an interned
+   symbol, so it needs no protection from GC.  */
+struct treesit_fontify_capture
+{
+  Lisp_Object name;
+  TSNode node;
+};
+
+/* Return the symbol for capture ID of QUERY, interning it the first
+   time and caching it in the vector NAMES.  */
+static Lisp_Object
+treesit_capture_name (TSQuery *query, Lisp_Object names, uint32_t id)
+{
+  Lisp_Object name = AREF (names, id);
+  if (NILP (name))
+    {
+      uint32_t len;
+      const char *str = ts_query_capture_name_for_id (query, id, &len);
+      name = intern_c_string_1 (str, len);
+      ASET (names, id, name);
+    }
+  return name;
+}
+
+/* Apply FACE to the text between START and END of the current buffer,
+   like treesit-fontify-with-override.  The common values of OVERRIDE
+   are handled here; the others are left to the Lisp function.  */
+static void
+treesit_fontify_with_override (ptrdiff_t start, ptrdiff_t end,
+			       Lisp_Object face, Lisp_Object override)
+{
+  Lisp_Object lstart = make_fixnum (start);
+  Lisp_Object lend = make_fixnum (end);
+  if (NILP (override))
+    {
+      if (NILP (Ftext_property_not_all (lstart, lend, Qface, Qnil, Qnil)))
+	Fput_text_property (lstart, lend, Qface, face, Qnil);
+    }
+  else if (EQ (override, Qt))
+    Fput_text_property (lstart, lend, Qface, face, Qnil);
+  else
+    calln (Qtreesit_fontify_with_override, lstart, lend, face, override);
+}
+
+DEFUN ("treesit--query-fontify",
+       Ftreesit__query_fontify,
+       Streesit__query_fontify, 7, 7, 0,
+       doc: /* Fontify the text between BEG and END with QUERY.
+
+Query NODE with QUERY between QUERY-BEG and QUERY-END, and handle each
+capture like `treesit-font-lock-fontify-region' does: if the capture
+name is a face, apply it with `treesit-fontify-with-override' to the
+part of the captured node between BEG and END, according to OVERRIDE;
+if it is a function, call it with the captured node, OVERRIDE, BEG and
+END.  Return nil.
+
+This is much faster than going through `treesit-query-capture', as no
+list of captures is made, and no node object is made for captures
+that name faces.
+
+NODE can be a node, a parser or a language symbol, like for
+`treesit-query-capture'.  */)
+  (Lisp_Object node, Lisp_Object query, Lisp_Object query_beg,
+   Lisp_Object query_end, Lisp_Object beg, Lisp_Object end,
+   Lisp_Object override)
+{
+  if (!(TS_COMPILED_QUERY_P (query)
+	|| CONSP (query) || STRINGP (query)))
+    wrong_type_argument (Qtreesit_query_p, query);
+
+  treesit_initialize ();
+
+  Lisp_Object lisp_node = treesit_resolve_node (node);
+  treesit_check_node (lisp_node);
+  Lisp_Object lisp_parser = XTS_NODE (lisp_node)->parser;
+  struct Lisp_TS_Parser *parser = XTS_PARSER (lisp_parser);
+  struct buffer *buf = XBUFFER (parser->buffer);
+  treesit_check_position (query_beg, buf);
+  treesit_check_position (query_end, buf);
+  treesit_check_position (beg, buf);
+  treesit_check_position (end, buf);
+
+  const TSLanguage *lang = ts_parser_language (parser->parser);
+  TSQuery *treesit_query;
+  TSQueryCursor *cursor;
+  bool needs_to_free_query_and_cursor;
+  Lisp_Object signal_symbol;
+  Lisp_Object signal_data;
+  if (!treesit_initialize_query (query, lang, &treesit_query, &cursor,
+				 &needs_to_free_query_and_cursor,
+				 &signal_symbol, &signal_data))
+    xsignal (signal_symbol, signal_data);
+
+  specpdl_ref count = SPECPDL_INDEX ();
+  record_unwind_current_buffer ();
+  set_buffer_internal (buf);
+
+  ptrdiff_t visible_beg = parser->visible_beg;
+  ts_query_cursor_set_byte_range (cursor,
+				  CHAR_TO_BYTE (XFIXNUM (query_beg))
+				  - visible_beg,
+				  CHAR_TO_BYTE (XFIXNUM (query_end))
+				  - visible_beg);
+  ts_query_cursor_exec (cursor, treesit_query, XTS_NODE (lisp_node)->node);
+
+  /* First collect the captures of the matches that pass their
+     predicates, and only then fontify: the functions we call could
+     reparse the buffer, which would pull the tree out from under the
+     query cursor.  */
+  uint32_t patterns_count = ts_query_pattern_count (treesit_query);
+  Lisp_Object predicates_table
+    = (TS_COMPILED_QUERY_P (query) ? XTS_COMPILED_QUERY (query)->predicates
+       : make_vector (patterns_count, Qt));
+  Lisp_Object names
+    = make_nil_vector (ts_query_capture_count (treesit_query));
+  Lisp_Object predicate_signal_data = Qnil;
+  struct treesit_fontify_capture *captures = NULL;
+  ptrdiff_t ncaptures = 0;
+  ptrdiff_t captures_size = 0;
+  specpdl_ref captures_count = SPECPDL_INDEX ();
+  record_unwind_protect_ptr (xfree, captures);
+
+  TSQueryMatch match;
+  while (ts_query_cursor_next_match (cursor, &match))
+    {
+      Lisp_Object predicates = AREF (predicates_table, match.pattern_index);
+      if (BASE_EQ (predicates, Qt))
+	{
+	  predicates = treesit_predicates_for_pattern (treesit_query,
+						       match.pattern_index);
+	  ASET (predicates_table, match.pattern_index, predicates);
+	}
+      /* Only matches with predicates need Lisp captures.  */
+      if (!NILP (predicates))
+	{
+	  Lisp_Object match_captures = Qnil;
+	  for (int idx = 0; idx < match.capture_count; idx++)
+	    match_captures
+	      = Fcons (Fcons (treesit_capture_name (treesit_query, names,
+						    match.captures[idx].index),
+			      make_treesit_node (lisp_parser,
+						 match.captures[idx].node)),
+		       match_captures);
+	  struct capture_range captures_range = { match_captures, Qnil };
+	  bool pass = treesit_eval_predicates (captures_range, predicates,
+					       &predicate_signal_data);
+	  if (!NILP (predicate_signal_data))
+	    break;
+	  if (!pass)
+	    continue;
+	}
+
+      if (captures_size - ncaptures < match.capture_count)
+	{
+	  captures = xpalloc (captures, &captures_size,
+			      match.capture_count - (captures_size - ncaptures),
+			      -1, sizeof *captures);
+	  set_unwind_protect_ptr (captures_count, xfree, captures);
+	}
+      for (int idx = 0; idx < match.capture_count; idx++)
+	{
+	  captures[ncaptures].name
+	    = treesit_capture_name (treesit_query, names,
+				    match.captures[idx].index);
+	  captures[ncaptures].node = match.captures[idx].node;
+	  ncaptures++;
+	}
+    }
+
+  if (needs_to_free_query_and_cursor)
+    {
+      ts_query_delete (treesit_query);
+      ts_query_cursor_delete (cursor);
+    }
+  if (!NILP (predicate_signal_data))
+    xsignal (Qtreesit_query_error, predicate_signal_data);
+
+  ptrdiff_t timestamp = parser->timestamp;
+  EMACS_INT beg_pos = XFIXNUM (beg);
+  EMACS_INT end_pos = XFIXNUM (end);
+  for (ptrdiff_t i = 0; i < ncaptures; i++)
+    {
+      /* The nodes are gone if a function reparsed the buffer.  */
+      if (parser->timestamp != timestamp)
+	xsignal1 (Qtreesit_node_outdated, lisp_node);
+      if (!BUFFER_LIVE_P (buf))
+	break;
+      set_buffer_internal (buf);
+
+      Lisp_Object face = captures[i].name;
+      TSNode treesit_node = captures[i].node;
+      if (!NILP (Finternal_lisp_face_p (face, Qnil)))
+	{
+	  /* Skip nodes outside the region: they are fontified with the
+	     region containing them.  */
+	  ptrdiff_t node_start
+	    = BYTE_TO_CHAR (visible_beg + ts_node_start_byte (treesit_node));
+	  ptrdiff_t node_end
+	    = BYTE_TO_CHAR (visible_beg + ts_node_end_byte (treesit_node));
+	  if (beg_pos < node_end && node_start < end_pos)
+	    treesit_fontify_with_override (max (node_start, beg_pos),
+					   min (node_end, end_pos),
+					   face, override);
+	}
+      else if (FUNCTIONP (face))
+	calln (face, make_treesit_node (lisp_parser, treesit_node),
+	       override, beg, end);
+    }
+
+  return unbind_to (count, Qnil);
+}
+
 
 /*** Navigation  */
 
@@ -4321,6 +5018,231 @@ treesit_traverse_child_helper (TSTreeCursor *cursor,
     }
 }
 
+/*** Tree cursors  */
+
+/* The node type strings returned by treesit-cursor-type, as a list of
+   (LANGUAGE . NAMES), where LANGUAGE is the TSLanguage pointer and
+   NAMES a vector of strings or nil, indexed by grammar symbol.  */
+static Lisp_Object treesit_type_names;
+
+/* Return the type of NODE, a node of LANGUAGE, as a string that is
+   shared by all the nodes of that type.  */
+static Lisp_Object
+treesit_node_type_name (const TSLanguage *language, TSNode node)
+{
+  Lisp_Object names = Qnil;
+  for (Lisp_Object tail = treesit_type_names; CONSP (tail);
+       tail = XCDR (tail))
+    if (xmint_pointer (XCAR (XCAR (tail))) == language)
+      {
+	names = XCDR (XCAR (tail));
+	break;
+      }
+  if (NILP (names))
+    {
+      names = make_nil_vector (ts_language_symbol_count (language));
+      treesit_type_names = Fcons (Fcons (make_mint_ptr ((void *) language),
+					 names),
+				  treesit_type_names);
+    }
+
+  /* ERROR nodes have a symbol beyond the others.  */
+  TSSymbol symbol = ts_node_symbol (node);
+  Lisp_Object name = symbol < ASIZE (names) ? AREF (names, symbol) : Qnil;
+  if (NILP (name))
+    {
+      const char *type = ts_node_type (node);
+      name = type == NULL ? Vtreesit_str_empty : build_string (type);
+      if (symbol < ASIZE (names))
+	ASET (names, symbol, name);
+    }
+  return name;
+}
+
+/* Check that CURSOR is a cursor whose tree is still the tree of its
+   parser, and whose buffer is live, and signal an error if not.  */
+static void
+treesit_check_cursor (Lisp_Object cursor)
+{
+  CHECK_TS_CURSOR (cursor);
+  struct Lisp_TS_Cursor *lisp_cursor = XTS_CURSOR (cursor);
+  struct Lisp_TS_Parser *parser = XTS_PARSER (lisp_cursor->parser);
+  if (lisp_cursor->timestamp != parser->timestamp)
+    xsignal1 (Qtreesit_node_outdated, cursor);
+  if (!BUFFER_LIVE_P (XBUFFER (parser->buffer)))
+    xsignal1 (Qtreesit_node_buffer_killed, cursor);
+}
+
+/* Called from alloc.c:cleanup_vector.  */
+void
+treesit_delete_cursor (struct Lisp_TS_Cursor *lisp_cursor)
+{
+  ts_tree_cursor_delete (&lisp_cursor->cursor);
+}
+
+DEFUN ("treesit-cursor-p",
+       Ftreesit_cursor_p, Streesit_cursor_p, 1, 1, 0,
+       doc: /* Return t if OBJECT is a tree-sitter cursor.  */)
+  (Lisp_Object object)
+{
+  return TS_CURSORP (object) ? Qt : Qnil;
+}
+
+DEFUN ("treesit-node-cursor",
+       Ftreesit_node_cursor, Streesit_node_cursor, 1, 1, 0,
+       doc: /* Return a new cursor pointing at NODE.
+
+A cursor walks the parse tree with `treesit-cursor-goto-parent',
+`treesit-cursor-goto-child' and `treesit-cursor-goto-sibling', and
+reads the node it points at with `treesit-cursor-type',
+`treesit-cursor-start' and `treesit-cursor-end', all without making a
+node object.  Use `treesit-cursor-node' to get the node itself.
+
+Like nodes, a cursor is outdated once the buffer is reparsed.  */)
+  (Lisp_Object node)
+{
+  treesit_check_node (node);
+  treesit_initialize ();
+
+  Lisp_Object parser = XTS_NODE (node)->parser;
+  TSTreeCursor cursor;
+  /* Start from the root, so that the cursor can go up from NODE.  If
+     the tree is too deep for that, settle for a cursor that can only
+     go down from NODE.  */
+  if (!treesit_cursor_helper (&cursor, XTS_NODE (node)->node, parser))
+    cursor = ts_tree_cursor_new (XTS_NODE (node)->node);
+
+  struct Lisp_TS_Cursor *lisp_cursor
+    = ALLOCATE_PSEUDOVECTOR (struct Lisp_TS_Cursor, parser, PVEC_TS_CURSOR);
+  lisp_cursor->parser = parser;
+  lisp_cursor->cursor = cursor;
+  lisp_cursor->timestamp = XTS_NODE (node)->timestamp;
+  return make_lisp_ptr (lisp_cursor, Lisp_Vectorlike);
+}
+
+DEFUN ("treesit-cursor-node",
+       Ftreesit_cursor_node, Streesit_cursor_node, 1, 1, 0,
+       doc: /* Return the node CURSOR points at.  */)
+  (Lisp_Object cursor)
+{
+  treesit_check_cursor (cursor);
+  treesit_initialize ();
+
+  struct Lisp_TS_Cursor *lisp_cursor = XTS_CURSOR (cursor);
+  return make_treesit_node (lisp_cursor->parser,
+			    ts_tree_cursor_current_node (&lisp_cursor->cursor));
+}
+
+DEFUN ("treesit-cursor-goto-parent",
+       Ftreesit_cursor_goto_parent, Streesit_cursor_goto_parent, 1, 1, 0,
+       doc: /* Move CURSOR to the parent of the node it points at.
+Return t if CURSOR moved, nil if there is no parent.  */)
+  (Lisp_Object cursor)
+{
+  treesit_check_cursor (cursor);
+  treesit_initialize ();
+
+  return (ts_tree_cursor_goto_parent (&XTS_CURSOR (cursor)->cursor)
+	  ? Qt : Qnil);
+}
+
+DEFUN ("treesit-cursor-goto-child",
+       Ftreesit_cursor_goto_child, Streesit_cursor_goto_child, 1, 3, 0,
+       doc: /* Move CURSOR to the first child of the node it points at.
+If BACKWARD is non-nil, move to the last child instead.  If NAMED is
+non-nil, only consider named children.  Return t if CURSOR moved, nil
+if there is no such child.  */)
+  (Lisp_Object cursor, Lisp_Object backward, Lisp_Object named)
+{
+  treesit_check_cursor (cursor);
+  treesit_initialize ();
+
+  /* treesit_traverse_child_helper leaves CURSOR alone if it fails.  */
+  return (treesit_traverse_child_helper (&XTS_CURSOR (cursor)->cursor,
+					 NILP (backward), !NILP (named))
+	  ? Qt : Qnil);
+}
+
+DEFUN ("treesit-cursor-goto-sibling",
+       Ftreesit_cursor_goto_sibling, Streesit_cursor_goto_sibling, 1, 3, 0,
+       doc: /* Move CURSOR to the next sibling of the node it points at.
+If BACKWARD is non-nil, move to the previous sibling instead.  If NAMED
+is non-nil, only consider named siblings.  Return t if CURSOR moved,
+nil if there is no such sibling.  */)
+  (Lisp_Object cursor, Lisp_Object backward, Lisp_Object named)
+{
+  treesit_check_cursor (cursor);
+  treesit_initialize ();
+
+  TSTreeCursor *tree_cursor = &XTS_CURSOR (cursor)->cursor;
+  /* Going to the next sibling doesn't move the cursor when there is
+     none, but otherwise treesit_traverse_sibling_helper may leave it
+     anywhere among the siblings, so remember where we started.  */
+  if (NILP (backward) && NILP (named))
+    return ts_tree_cursor_goto_next_sibling (tree_cursor) ? Qt : Qnil;
+
+  TSTreeCursor start = ts_tree_cursor_copy (tree_cursor);
+  if (treesit_traverse_sibling_helper (tree_cursor, NILP (backward),
+				       !NILP (named)))
+    {
+      ts_tree_cursor_delete (&start);
+      return Qt;
+    }
+  ts_tree_cursor_delete (tree_cursor);
+  *tree_cursor = start;
+  return Qnil;
+}
+
+DEFUN ("treesit-cursor-type",
+       Ftreesit_cursor_type, Streesit_cursor_type, 1, 1, 0,
+       doc: /* Return the type of the node CURSOR points at, as a string.
+The string is shared by all nodes of that type, so don't modify it.  */)
+  (Lisp_Object cursor)
+{
+  treesit_check_cursor (cursor);
+  treesit_initialize ();
+
+  struct Lisp_TS_Cursor *lisp_cursor = XTS_CURSOR (cursor);
+  TSParser *parser = XTS_PARSER (lisp_cursor->parser)->parser;
+  TSNode node = ts_tree_cursor_current_node (&lisp_cursor->cursor);
+  return treesit_node_type_name (ts_parser_language (parser), node);
+}
+
+/* Return the buffer position of byte offset OFFSET of the tree of
+   CURSOR.  */
+static Lisp_Object
+treesit_cursor_position (Lisp_Object cursor, uint32_t offset)
+{
+  struct Lisp_TS_Parser *parser
+    = XTS_PARSER (XTS_CURSOR (cursor)->parser);
+  return make_fixnum (buf_bytepos_to_charpos (XBUFFER (parser->buffer),
+					      offset + parser->visible_beg));
+}
+
+DEFUN ("treesit-cursor-start",
+       Ftreesit_cursor_start, Streesit_cursor_start, 1, 1, 0,
+       doc: /* Return the start position of the node CURSOR points at.  */)
+  (Lisp_Object cursor)
+{
+  treesit_check_cursor (cursor);
+  treesit_initialize ();
+
+  TSNode node = ts_tree_cursor_current_node (&XTS_CURSOR (cursor)->cursor);
+  return treesit_cursor_position (cursor, ts_node_start_byte (node));
+}
+
+DEFUN ("treesit-cursor-end",
+       Ftreesit_cursor_end, Streesit_cursor_end, 1, 1, 0,
+       doc: /* Return the end position of the node CURSOR points at.  */)
+  (Lisp_Object cursor)
+{
+  treesit_check_cursor (cursor);
+  treesit_initialize ();
+
+  TSNode node = ts_tree_cursor_current_node (&XTS_CURSOR (cursor)->cursor);
+  return treesit_cursor_position (cursor, ts_node_end_byte (node));
+}
+
 /* Given a symbol THING, and a language symbol LANGUAGE, find the
    corresponding predicate definition in treesit-thing-settings.
    Don't check for the type of THING and LANGUAGE.
@@ -5127,8 +6049,10 @@ syms_of_treesit (void)
 #if HAVE_TREE_SITTER
   DEFSYM (Qtreesit_parser_p, "treesit-parser-p");
   DEFSYM (Qtreesit_node_p, "treesit-node-p");
+  DEFSYM (Qtreesit_cursor_p, "treesit-cursor-p");
   DEFSYM (Qtreesit_compiled_query_p, "treesit-compiled-query-p");
   DEFSYM (Qtreesit_query_p, "treesit-query-p");
+  DEFSYM (Qtreesit_fontify_with_override, "treesit-fontify-with-override");
   DEFSYM (Qnamed, "named");
   DEFSYM (Qanonymous, "anonymous");
   DEFSYM (Qmissing, "missing");
@@ -5350,6 +6274,12 @@ cons (REGEXP . FN), which is a combination of a regexp and a predicate
   staticpro (&Vtreesit_str_empty);
   Vtreesit_str_empty = build_string ("");
 
+  staticpro (&treesit_async_parsers);
+  treesit_async_parsers = Qnil;
+
+  staticpro (&treesit_type_names);
+  treesit_type_names = Qnil;
+
   defsubr (&Streesit_language_available_p);
   defsubr (&Streesit_library_abi_version);
   defsubr (&Streesit_language_abi_version);
@@ -5375,6 +6305,7 @@ cons (REGEXP . FN), which is a combination of a regexp and a predicate
   defsubr (&Streesit_parser_embed_level);
   defsubr (&Streesit_parser_set_embed_level);
   defsubr (&Streesit_parser_changed_regions);
+  defsubr (&Streesit_parser_parse_in_background);
 
   defsubr (&Streesit_parser_root_node);
   defsubr (&Streesit_parse_string);
@@ -5406,6 +6337,17 @@ cons (REGEXP . FN), which is a combination of a regexp and a predicate
   defsubr (&Streesit_query_expand);
   defsubr (&Streesit_query_compile);
   defsubr (&Streesit_query_capture);
+  defsubr (&Streesit__query_fontify);
+
+  defsubr (&Streesit_cursor_p);
+  defsubr (&Streesit_node_cursor);
+  defsubr (&Streesit_cursor_node);
+  defsubr (&Streesit_cursor_goto_parent);
+  defsubr (&Streesit_cursor_goto_child);
+  defsubr (&Streesit_cursor_goto_sibling);
+  defsubr (&Streesit_cursor_type);
+  defsubr (&Streesit_cursor_start);
+  defsubr (&Streesit_cursor_end);
 
   defsubr (&Streesit_search_subtree);
   defsubr (&Streesit_search_forward);
@@ -75,6 +75,12 @@ #define EMACS_TREESIT_H
   Lisp_Object embed_level;
   /* The buffer associated with this parser.  */
   Lisp_Object buffer;
+  /* A small vector of recently made nodes, indexed by a hash of their
+     TSNode, or nil.  make_treesit_node returns the cached node object
+     when asked for the same node again with the same timestamp, so
+     walking a tree up and down doesn't allocate a node object at
+     each step.  */
+  Lisp_Object node_cache;
   /* The pointer to the tree-sitter parser.  Never NULL.  */
   TSParser *parser;
   /* Pointer to the syntax tree.  Initially is NULL, so check for NULL
@@ -82,6 +88,9 @@ #define EMACS_TREESIT_H
   TSTree *tree;
   /* Teaches tree-sitter how to read an Emacs buffer.  */
   TSInput input;
+  /* The parse running on a background thread, or NULL.  See
+     treesit-parser-parse-in-background.  */
+  struct treesit_async_parse *async_parse;
   /* Re-parsing an unchanged buffer is not free for tree-sitter, so we
      only make it re-parse when need_reparse == true.  That usually
      means some change is made in the buffer.  But others could set
@@ -141,6 +150,18 @@ #define EMACS_TREESIT_H
   ptrdiff_t timestamp;
 };
 
+/* A tree-sitter tree cursor.  It walks the tree of its parser
+   without making a node object at each step.  */
+struct Lisp_TS_Cursor
+{
+  union vectorlike_header header;
+  /* Like for nodes, this keeps the parser, and thus the tree, alive.  */
+  Lisp_Object parser;
+  TSTreeCursor cursor;
+  /* The timestamp of the parser when the cursor was made.  */
+  ptrdiff_t timestamp;
+};
+
 /* A compiled tree-sitter query.
 
    When we create a query object by treesit-compile-query, it is not
@@ -159,6 +180,12 @@ #define EMACS_TREESIT_H
   Lisp_Object language;
   /* Source lisp (sexp or string) query.  */
   Lisp_Object source;
+  /* A vector holding the predicates of each pattern of the query, in
+     the form returned by treesit_predicates_for_pattern, or nil if
+     the query is not compiled yet.  Compiling them once saves
+     treesit-query-capture from parsing predicate strings for every
+     match.  */
+  Lisp_Object predicates;
   /* Pointer to the query object.  This can be NULL, meaning this query
      is not initialized/compiled.  We compile the query when it is used
      the first time.  (See treesit_ensure_query_compiled.)  */
@@ -197,6 +224,19 @@ XTS_NODE (Lisp_Object a)
   return XUNTAG (a, Lisp_Vectorlike, struct Lisp_TS_Node);
 }
 
+INLINE bool
+TS_CURSORP (Lisp_Object x)
+{
+  return PSEUDOVECTORP (x, PVEC_TS_CURSOR);
+}
+
+INLINE struct Lisp_TS_Cursor *
+XTS_CURSOR (Lisp_Object a)
+{
+  eassert (TS_CURSORP (a));
+  return XUNTAG (a, Lisp_Vectorlike, struct Lisp_TS_Cursor);
+}
+
 INLINE bool
 TS_COMPILED_QUERY_P (Lisp_Object x)
 {
@@ -222,6 +262,12 @@ CHECK_TS_NODE (Lisp_Object node)
   CHECK_TYPE (TS_NODEP (node), Qtreesit_node_p, node);
 }
 
+INLINE void
+CHECK_TS_CURSOR (Lisp_Object cursor)
+{
+  CHECK_TYPE (TS_CURSORP (cursor), Qtreesit_cursor_p, cursor);
+}
+
 INLINE void
 CHECK_TS_COMPILED_QUERY (Lisp_Object query)
 {
@@ -252,7 +298,9 @@ CHECK_TS_COMPILED_QUERY (Lisp_Object query)
 extern bool treesit_node_buffer_live_p (Lisp_Object);
 
 extern void treesit_delete_parser (struct Lisp_TS_Parser *);
+extern void treesit_install_async_parses (void);
 extern void treesit_delete_query (struct Lisp_TS_Query *);
+extern void treesit_delete_cursor (struct Lisp_TS_Cursor *);
 extern bool treesit_named_node_p (TSNode);
 extern bool treesit_node_eq (Lisp_Object, Lisp_Object);
 
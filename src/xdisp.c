@@ -23806,16 +23806,23 @@ insert_left_trunc_glyphs (struct it *it)
 unsigned
 row_hash (struct glyph_row *row)
 {
-  int area, k;
   unsigned hashval = 0;
 
-  for (area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
-    for (k = 0; k < row->used[area]; ++k)
-      hashval = ((((hashval << 4) + (hashval >> 24)) & 0x0fffffff)
-		  + row->glyphs[area][k].u.val
-		  + row->glyphs[area][k].face_id
-		  + row->glyphs[area][k].padding_p
-		  + (row->glyphs[area][k].type << 2));
+  for (int area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+    {
+      /* Walk the glyphs with a pointer, so that the glyph count and
+	 base address of the area need not be reloaded for every
+	 glyph.  */
+      struct glyph *glyph = row->glyphs[area];
+      struct glyph *end = glyph + row->used[area];
+
+      for (; glyph < end; ++glyph)
+	hashval = ((((hashval << 4) + (hashval >> 24)) & 0x0fffffff)
+		   + glyph->u.val
+		   + glyph->face_id
+		   + glyph->padding_p
+		   + (glyph->type << 2));
+    }
 
   return hashval;
 }
@@ -4776,6 +4776,7 @@ make_face_cache (struct frame *f)
   c->size = 50;
   c->used = 0;
   c->faces_by_id = xmalloc (c->size * sizeof *c->faces_by_id);
+  c->merge_cache = NULL;
   c->f = f;
   c->menu_face_changed_p = menu_face_changed_default;
   return c;
@@ -4811,6 +4812,18 @@ clear_face_gcs (struct face_cache *c)
 
 #endif /* HAVE_WINDOW_SYSTEM */
 
+/* Empty the merge cache of face cache C.  This must be done whenever
+   a realized face of C is freed, since its ID can then be reused by
+   a different face.  */
+
+static void
+clear_face_merge_cache (struct face_cache *c)
+{
+  if (c->merge_cache)
+    memset (c->merge_cache, 0,
+	    FACE_MERGE_CACHE_SIZE * sizeof *c->merge_cache);
+}
+
 /* Free all realized faces in face cache C, including basic faces.
    C may be null.  If faces are freed, make sure the frame's current
    matrix is marked invalid, so that a display caused by an expose
@@ -4837,6 +4850,7 @@ free_realized_faces (struct face_cache *c)
 
       /* Forget the escape-glyph and glyphless-char faces.  */
       forget_escape_and_glyphless_faces ();
+      clear_face_merge_cache (c);
       c->used = 0;
       size = FACE_CACHE_BUCKETS_SIZE * sizeof *c->buckets;
       memset (c->buckets, 0, size);
@@ -4885,6 +4899,7 @@ free_face_cache (struct face_cache *c)
       free_realized_faces (c);
       xfree (c->buckets);
       xfree (c->faces_by_id);
+      xfree (c->merge_cache);
       xfree (c);
     }
 }
@@ -4983,6 +4998,8 @@ uncache_face (struct face_cache *c, struct face *face)
   c->faces_by_id[face->id] = NULL;
   if (face->id == c->used)
     --c->used;
+
+  clear_face_merge_cache (c);
 }
 
 
@@ -6799,6 +6816,98 @@ compute_char_face (struct frame *f, int ch, Lisp_Object prop)
   return face_id;
 }
 
+/* Maximum length of a list of face names that face_merge_cache_hash
+   accepts.  */
+
+enum { FACE_MERGE_CACHE_MAX_LIST = 8 };
+
+/* Return the hash code for looking up the `face' property value PROP
+   in a merge cache, or zero if PROP is not suitable for caching.  Only
+   face names and short lists of face names are: since these are
+   compared element by element with `eq', a value is never confused
+   with another one, even if it is a list that is later modified.  */
+
+static EMACS_UINT
+face_merge_cache_hash (Lisp_Object prop)
+{
+  if (SYMBOLP (prop))
+    return NILP (prop) ? 0 : XHASH (prop) | 1;
+
+  EMACS_UINT hash = 0;
+  int n = 0;
+
+  for (; CONSP (prop); prop = XCDR (prop))
+    {
+      if (!SYMBOLP (XCAR (prop)) || ++n > FACE_MERGE_CACHE_MAX_LIST)
+	return 0;
+      hash = sxhash_combine (hash, XHASH (XCAR (prop)));
+    }
+
+  return n > 0 && NILP (prop) ? hash | 1 : 0;
+}
+
+/* Return true if the `face' property values A and B, the latter
+   accepted by face_merge_cache_hash, are equal.  */
+
+static bool
+face_merge_cache_key_equal (Lisp_Object a, Lisp_Object b)
+{
+  if (SYMBOLP (a))
+    return EQ (a, b);
+
+  for (; CONSP (a) && CONSP (b); a = XCDR (a), b = XCDR (b))
+    if (!EQ (XCAR (a), XCAR (b)))
+      return false;
+
+  return NILP (a) && NILP (b);
+}
+
+/* Return the entry of the merge cache of frame F that the `face'
+   property value PROP with hash code HASH, merged into face BASE_FACE_ID
+   with attribute filter ATTR_FILTER, maps to.  The entry need not be
+   for PROP; check with face_merge_cache_key_equal.  */
+
+static struct face_merge_cache_entry *
+face_merge_cache_entry (struct frame *f, EMACS_UINT hash, int base_face_id,
+			enum lface_attribute_index attr_filter)
+{
+  struct face_cache *c = FRAME_FACE_CACHE (f);
+
+  if (!c->merge_cache)
+    c->merge_cache = xzalloc (FACE_MERGE_CACHE_SIZE
+			      * sizeof *c->merge_cache);
+
+  hash = sxhash_combine (hash, base_face_id);
+  hash = sxhash_combine (hash, attr_filter);
+  return &c->merge_cache[(hash ^ (hash >> 16)) & (FACE_MERGE_CACHE_SIZE - 1)];
+}
+
+DEFUN ("internal--face-merge-cache", Finternal__face_merge_cache,
+       Sinternal__face_merge_cache, 0, 1, 0,
+       doc: /* Return the entries of the face merge cache of FRAME.
+Each entry is a list (PROP BASE-FACE-ID FACE-ID), meaning that merging
+the `face' property value PROP into the face BASE-FACE-ID gave the face
+FACE-ID.  For internal use only.  */)
+  (Lisp_Object frame)
+{
+  struct frame *f = decode_live_frame (frame);
+  struct face_cache *c = FRAME_FACE_CACHE (f);
+  Lisp_Object entries = Qnil;
+
+  if (c && c->merge_cache)
+    for (int i = FACE_MERGE_CACHE_SIZE - 1; i >= 0; i--)
+      {
+	struct face_merge_cache_entry *entry = &c->merge_cache[i];
+	if (!NILP (entry->prop))
+	  entries = Fcons (list3 (entry->prop,
+				  make_fixnum (entry->base_face_id),
+				  make_fixnum (entry->face_id)),
+			   entries);
+      }
+
+  return entries;
+}
+
 /* Return the face ID associated with buffer position POS for
    displaying ASCII characters.  Return in *ENDPTR the position at
    which a different face is needed, as far as text properties and
@@ -6896,6 +7005,30 @@ face_at_buffer_position (struct window *w, ptrdiff_t pos,
       return default_face->id;
     }
 
+  /* Merging the same face names into the same face always gives the
+     same result, unless face remapping, which depends on the buffer
+     and window, is in effect.  Look for a cached result, since
+     merging and realizing faces is expensive.  */
+  struct face_merge_cache_entry *entry = NULL;
+  if (noverlays == 0 && NILP (Vface_remapping_alist))
+    {
+      EMACS_UINT hash = face_merge_cache_hash (prop);
+
+      if (hash)
+	{
+	  entry = face_merge_cache_entry (f, hash, default_face->id,
+					  attr_filter);
+	  if (entry->base_face_id == default_face->id
+	      && entry->attr_filter == attr_filter
+	      && face_merge_cache_key_equal (entry->prop, prop)
+	      && FACE_FROM_ID_OR_NULL (f, entry->face_id))
+	    {
+	      SAFE_FREE ();
+	      return entry->face_id;
+	    }
+	}
+    }
+
   /* Begin with attributes from the default face.  */
   memcpy (attrs, default_face->lface, sizeof(attrs));
 
@@ -6903,6 +7036,19 @@ face_at_buffer_position (struct window *w, ptrdiff_t pos,
   if (!NILP (prop))
     merge_face_ref (w, f, prop, attrs, true, NULL, attr_filter);
 
+  if (entry)
+    {
+      /* Copy lists, so that the entry doesn't change if PROP is
+	 modified.  */
+      entry->prop = SYMBOLP (prop) ? prop : Fcopy_sequence (prop);
+      entry->base_face_id = default_face->id;
+      entry->attr_filter = attr_filter;
+      entry->face_id = lookup_face (f, attrs);
+
+      SAFE_FREE ();
+      return entry->face_id;
+    }
+
   /* Now merge the overlay data.  */
   noverlays = sort_overlays (overlay_vec, noverlays, w);
   /* For mouse-face, we need only the single highest-priority face
@@ -7515,6 +7661,7 @@ syms_of_xfaces (void)
   defsubr (&Sinternal_merge_in_global_face);
   defsubr (&Sface_font);
   defsubr (&Sframe_face_hash_table);
+  defsubr (&Sinternal__face_merge_cache);
   defsubr (&Sdisplay_supports_face_attributes_p);
   defsubr (&Scolor_distance);
   defsubr (&Sinternal_set_font_selection_order);
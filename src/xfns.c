@@ -3943,9 +3943,17 @@ xic_string_conversion_callback (XIC ic, XPointer client_data,
 x_mark_frame_dirty (struct frame *f)
 {
 #ifdef HAVE_XDBE
-  if (FRAME_X_DOUBLE_BUFFERED_P (f)
-      && !FRAME_X_NEED_BUFFER_FLIP (f))
-    FRAME_X_NEED_BUFFER_FLIP (f) = true;
+  if (FRAME_X_DOUBLE_BUFFERED_P (f))
+    {
+      if (!FRAME_X_NEED_BUFFER_FLIP (f))
+	FRAME_X_NEED_BUFFER_FLIP (f) = true;
+
+      /* Drawing not announced through x_damage_begin can touch any
+	 part of the back buffer.  */
+      if (!f->output_data.x->damage_depth
+	  && !f->output_data.x->damage_full_p)
+	f->output_data.x->damage_full_p = true;
+    }
 #endif
 }
 
@@ -7525,6 +7525,83 @@ x_draw_window_divider (struct window *w, int x0, int x1, int y0, int y1)
     }
 }
 
+/* Announce that the drawing operations up to the next call to
+   x_damage_end will only touch the part of frame F's back buffer
+   within the rectangle X, Y, WIDTH, HEIGHT.  When all drawing since
+   the back buffer was last displayed has been announced like this,
+   show_back_buffer copies just the damaged area to the screen instead
+   of swapping the whole buffer, which saves a great deal of memory
+   bandwidth on large frames when only the cursor or a few lines
+   change.  */
+
+static void
+x_damage_begin (struct frame *f, int x, int y, int width, int height)
+{
+#ifdef HAVE_XDBE
+  struct x_output *output = f->output_data.x;
+
+  output->damage_depth++;
+
+  if (!FRAME_X_DOUBLE_BUFFERED_P (f)
+      || output->damage_full_p
+      || width <= 0 || height <= 0)
+    return;
+
+  if (output->damage_x0 >= output->damage_x1)
+    {
+      output->damage_x0 = x;
+      output->damage_y0 = y;
+      output->damage_x1 = x + width;
+      output->damage_y1 = y + height;
+    }
+  else
+    {
+      output->damage_x0 = min (output->damage_x0, x);
+      output->damage_y0 = min (output->damage_y0, y);
+      output->damage_x1 = max (output->damage_x1, x + width);
+      output->damage_y1 = max (output->damage_y1, y + height);
+    }
+#endif
+}
+
+/* Like x_damage_begin, but for drawing confined to the glyph row ROW
+   of window W.  OVERLAPS_P means the drawing can extend into the rows
+   above and below, anywhere in the text area of W.  */
+
+static void
+x_damage_begin_for_row (struct window *w, struct glyph_row *row,
+			bool overlaps_p)
+{
+  int y0, y1;
+
+  if (overlaps_p)
+    {
+      y0 = 0;
+      y1 = WINDOW_PIXEL_HEIGHT (w);
+    }
+  else
+    {
+      y0 = max (0, row->y);
+      y1 = row->y + max (row->height, row->visible_height);
+    }
+
+  x_damage_begin (XFRAME (WINDOW_FRAME (w)), WINDOW_LEFT_EDGE_X (w),
+		  WINDOW_TO_FRAME_PIXEL_Y (w, y0), WINDOW_PIXEL_WIDTH (w),
+		  y1 - y0);
+}
+
+/* End the drawing operations started by the last call to
+   x_damage_begin on frame F.  */
+
+static void
+x_damage_end (struct frame *f)
+{
+#ifdef HAVE_XDBE
+  eassert (f->output_data.x->damage_depth > 0);
+  f->output_data.x->damage_depth--;
+#endif
+}
+
 #ifdef HAVE_XDBE
 
 /* Show the frame back buffer.  If frame is double-buffered,
@@ -7535,6 +7612,8 @@ x_draw_window_divider (struct window *w, int x0, int x1, int y0, int y1)
 show_back_buffer (struct frame *f)
 {
   XdbeSwapInfo swap_info;
+  struct x_output *output = f->output_data.x;
+  int width, height;
 #ifdef USE_CAIRO
   cairo_t *cr;
 #endif
@@ -7555,10 +7634,27 @@ show_back_buffer (struct frame *f)
       if (cr)
 	cairo_surface_flush (cairo_get_target (cr));
 #endif
-      memset (&swap_info, 0, sizeof (swap_info));
-      swap_info.swap_window = FRAME_X_WINDOW (f);
-      swap_info.swap_action = XdbeCopied;
-      XdbeSwapBuffers (FRAME_X_DISPLAY (f), &swap_info, 1);
+      width = output->damage_x1 - output->damage_x0;
+      height = output->damage_y1 - output->damage_y0;
+
+      /* The swap action is XdbeCopied, so the front buffer equals
+	 the back buffer outside the damaged area, and copying just
+	 that area gives the same result as swapping.  Do that if it
+	 is small enough to be worth the trouble.  */
+      if (!output->damage_full_p && width > 0 && height > 0
+	  && ((intmax_t) width * height
+	      < (intmax_t) FRAME_PIXEL_WIDTH (f) * FRAME_PIXEL_HEIGHT (f) / 2))
+	XCopyArea (FRAME_X_DISPLAY (f), FRAME_X_RAW_DRAWABLE (f),
+		   FRAME_X_WINDOW (f), output->normal_gc,
+		   output->damage_x0, output->damage_y0, width, height,
+		   output->damage_x0, output->damage_y0);
+      else
+	{
+	  memset (&swap_info, 0, sizeof (swap_info));
+	  swap_info.swap_window = FRAME_X_WINDOW (f);
+	  swap_info.swap_action = XdbeCopied;
+	  XdbeSwapBuffers (FRAME_X_DISPLAY (f), &swap_info, 1);
+	}
 
 #if defined HAVE_XSYNC && !defined USE_GTK && defined HAVE_CLOCK_GETTIME
       /* Finish the frame here.  */
@@ -7567,6 +7663,19 @@ show_back_buffer (struct frame *f)
     }
 
   FRAME_X_NEED_BUFFER_FLIP (f) = false;
+  output->damage_full_p = false;
+  output->damage_x0 = output->damage_x1 = 0;
+  output->damage_y0 = output->damage_y1 = 0;
+}
+
+/* Make the next call to show_back_buffer on frame F display its
+   entire back buffer, for example because the contents of the front
+   buffer were lost.  */
+
+static void
+x_damage_frame (struct frame *f)
+{
+  f->output_data.x->damage_full_p = true;
 }
 
 #endif
@@ -7862,6 +7971,7 @@ x_draw_fringe_bitmap (struct window *w, struct glyph_row *row,
 
   /* Must clip because of partially visible lines.  */
   x_clip_to_row (w, row, ANY_AREA, gc, &clip_rect);
+  x_damage_begin_for_row (w, row, false);
 
   if (p->bx >= 0 && !p->overlay_p)
     {
@@ -8049,6 +8159,7 @@ x_draw_fringe_bitmap (struct window *w, struct glyph_row *row,
 #endif  /* not USE_CAIRO */
 
   x_reset_clip_rectangles (f, gc);
+  x_damage_end (f);
 }
 
 /***********************************************************************
@@ -10935,6 +11046,10 @@ x_draw_glyph_string (struct glyph_string *s)
 {
   bool relief_drawn_p = false;
 
+  /* All drawing below is clipped to the row of S, or to the text area
+     of its window if S draws overlapping rows.  */
+  x_damage_begin_for_row (s->w, s->row, s->for_overlaps != 0);
+
   /* If S draws into the background of its successors, draw the
      background of the successors first so that S can draw into it.
      This makes S->next use XDrawString instead of XDrawImageString.  */
@@ -11295,6 +11410,8 @@ x_draw_glyph_string (struct glyph_string *s)
       && s->first_glyph->type != IMAGE_GLYPH
       && !s->row->stipple_p)
     s->row->stipple_p = s->stippled_p;
+
+  x_damage_end (s->f);
 }
 
 /* Shift display to make room for inserted glyphs.   */
@@ -11826,6 +11943,9 @@ x_scroll_run (struct window *w, struct run *run)
     }
 #endif
 
+  /* Only the destination of the copy changes.  */
+  x_damage_begin (f, x, to_y, width, height);
+
 #ifdef USE_CAIRO_XCB_SURFACE
   /* Some of the following code depends on `normal_gc' being
      up-to-date on the X server, but doesn't call a routine that will
@@ -11895,6 +12015,7 @@ x_scroll_run (struct window *w, struct run *run)
 	       width, height,
 	       x, to_y);
 
+  x_damage_end (f);
   unblock_input ();
 }
 
@@ -19938,7 +20059,10 @@ handle_one_xevent (struct x_display_info *dpyinfo,
 
 #ifdef HAVE_XDBE
           if (!FRAME_GARBAGED_P (f))
-            show_back_buffer (f);
+	    {
+	      x_damage_frame (f);
+	      show_back_buffer (f);
+	    }
 #endif
         }
       else
@@ -19976,6 +20100,7 @@ handle_one_xevent (struct x_display_info *dpyinfo,
 	  x_clear_under_internal_border (f);
 #endif
 #ifdef HAVE_XDBE
+	  x_damage_frame (f);
 	  show_back_buffer (f);
 #endif
         }
@@ -26020,7 +26145,9 @@ x_define_frame_cursor (struct frame *f, Emacs_Cursor cursor)
 static void
 x_clear_frame_area (struct frame *f, int x, int y, int width, int height)
 {
+  x_damage_begin (f, x, y, width, height);
   x_clear_area (f, x, y, width, height);
+  x_damage_end (f);
 }
 
 
@@ -26050,6 +26177,9 @@ x_draw_window_cursor (struct window *w, struct glyph_row *glyph_row, int x,
 	}
       else
 	{
+	  /* Cursors are clipped to their glyph row.  */
+	  x_damage_begin_for_row (w, glyph_row, false);
+
 	  switch (cursor_type)
 	    {
 	    case HOLLOW_BOX_CURSOR:
@@ -26075,6 +26205,8 @@ x_draw_window_cursor (struct window *w, struct glyph_row *glyph_row, int x,
 	    default:
 	      emacs_abort ();
 	    }
+
+	  x_damage_end (XFRAME (WINDOW_FRAME (w)));
 	}
 
 #ifdef HAVE_X_I18N
@@ -1237,6 +1237,21 @@ #define X_INVALID_WINDOW 0xffffffff
      complete and can be safely flushed while handling async
      input.  */
   bool_bf complete : 1;
+
+  /* Flag that indicates whether the back buffer was drawn into
+     outside the damage rectangle below, in which case it must be
+     swapped in its entirety.  */
+  bool_bf damage_full_p : 1;
+
+  /* Bounding box of the parts of the back buffer drawn into since it
+     was last displayed, in frame pixel coordinates.  Empty if
+     damage_x0 >= damage_x1.  */
+  int damage_x0, damage_y0, damage_x1, damage_y1;
+
+  /* Number of active calls to x_damage_begin.  Drawing performed
+     while this is zero is not accounted for in the rectangle
+     above.  */
+  int damage_depth;
 #endif
 
 #ifdef HAVE_X_I18N
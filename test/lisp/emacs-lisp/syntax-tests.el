@@ -60,4 +60,58 @@ syntax-propertize--shift-groups-and-backrefs
   (should-error
    (syntax-propertize--shift-groups-and-backrefs "\\(a\\)\\3" 7)))
 
+(defun syntax-tests--ppss-equal (pos)
+  "Non-nil if `syntax-ppss' at POS agrees with a full parse."
+  (let ((ppss (syntax-ppss pos))
+        (full (save-excursion (parse-partial-sexp (point-min) pos))))
+    (seq-every-p (lambda (i) (equal (nth i ppss) (nth i full)))
+                 '(0 1 3 4 8 9))))
+
+(ert-deftest syntax-ppss-after-changes ()
+  "Test that `syntax-ppss' notices changes to the buffer text."
+  (with-temp-buffer
+    (emacs-lisp-mode)
+    (dotimes (i 2000)
+      (insert (format "(defun f%d () \"doc\" ; comment\n  (list %d))\n" i i)))
+    (let ((positions (number-sequence 1 (point-max) 997)))
+      (dolist (pos positions)
+        (should (syntax-tests--ppss-equal pos)))
+      ;; Open a string near the start of the buffer.
+      (goto-char 100)
+      (insert "\"")
+      (dolist (pos positions)
+        (should (syntax-tests--ppss-equal pos)))
+      ;; The same, without running the modification hooks.
+      (let ((inhibit-modification-hooks t))
+        (goto-char 50)
+        (insert "\""))
+      (dolist (pos positions)
+        (should (syntax-tests--ppss-equal pos)))
+      ;; Change the text through an indirect buffer.
+      (let ((base (current-buffer)))
+        (with-current-buffer (make-indirect-buffer base " *indirect*")
+          (unwind-protect
+              (progn
+                (goto-char 20)
+                (insert ";")
+                (with-current-buffer base
+                  (dolist (pos positions)
+                    (should (syntax-tests--ppss-equal pos))))
+                ;; And the other way around, with checkpoints in the
+                ;; indirect buffer.
+                (emacs-lisp-mode)
+                (dolist (pos positions)
+                  (should (syntax-tests--ppss-equal pos)))
+                (with-current-buffer base
+                  (goto-char 30)
+                  (insert "\""))
+                (dolist (pos positions)
+                  (should (syntax-tests--ppss-equal pos))))
+            (kill-buffer))))
+      ;; A narrowed buffer uses a separate cache.
+      (save-restriction
+        (narrow-to-region 500 (point-max))
+        (dolist (pos (number-sequence 500 (point-max) 997))
+          (should (syntax-tests--ppss-equal pos)))))))
+
 ;;; syntax-tests.el ends here.
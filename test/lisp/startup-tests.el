@@ -25,6 +25,9 @@
 
 ;;; Code:
 
+(require 'ert)
+(require 'ert-x)
+
 (ert-deftest startup-tests/command-switch-alist ()
   (let* ((foo-args ()) (bar-args ())
          (command-switch-alist
@@ -44,4 +47,21 @@ startup-tests/command-switch-alist
     (should (equal foo-args '("--foo")))
     (should (equal bar-args '("--bar=value")))))
 
+(ert-deftest startup-tests/session-dump-stale-files ()
+  (ert-with-temp-file kept
+    (ert-with-temp-file changed
+      (ert-with-temp-file removed
+        (let ((startup--session-dump
+               (cons (current-time)
+                     (mapcar (lambda (file)
+                               (cons file
+                                     (file-attribute-modification-time
+                                      (file-attributes file))))
+                             (list kept changed removed)))))
+          (should-not (startup--session-dump-stale-files))
+          (set-file-times changed (time-add (current-time) 10))
+          (delete-file removed)
+          (should (equal (startup--session-dump-stale-files)
+                         (list changed removed))))))))
+
 ;;; startup-tests.el ends here
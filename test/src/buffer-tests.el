@@ -749,6 +749,32 @@ ac
   (58 66) (41 10) (9 67) (28 88) (27 43)
   (24 27) (48 36) (5 90) (61 9))
 
+(ert-deftest test-next-overlay-change-after-changes ()
+  "Test that `next-overlay-change' notices changes between calls."
+  (with-temp-buffer
+    (insert (make-string 100 ?\s))
+    (let ((ov (make-overlay 50 60)))
+      (should (= (next-overlay-change 10) 50))
+      (should (= (next-overlay-change 20) 50))
+      (make-overlay 30 30)
+      (should (= (next-overlay-change 20) 30))
+      (move-overlay ov 25 60)
+      (should (= (next-overlay-change 20) 25))
+      (goto-char 1)
+      (insert "xx")
+      (should (= (next-overlay-change 20) 27))
+      (delete-overlay ov)
+      (should (= (next-overlay-change 20) 32))
+      (should (= (next-overlay-change 40) (point-max)))
+      (narrow-to-region 1 50)
+      (should (= (next-overlay-change 40) 50))
+      (widen)
+      (with-temp-buffer
+        (insert (make-string 100 ?\s))
+        (make-overlay 45 46)
+        (should (= (next-overlay-change 40) 45)))
+      (should (= (next-overlay-change 40) (point-max))))))
+
 
 ;; +==========================================================================+
 ;; | previous-overlay-change.
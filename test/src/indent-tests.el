@@ -58,4 +58,64 @@ indent-tests-move-to-column-invis-between-tabs
       (buffer-substring-no-properties 1 14))
     "\txxx    \tLine")))
 
+(ert-deftest indent-tests-current-column-same-line ()
+  "Test `current-column' at several places of the same line."
+  (with-temp-buffer
+    (insert "ab\tcd\tef\tgh")
+    (put-text-property 1 2 'face 'bold)
+    (goto-char 6)
+    (should (= (current-column) 10))
+    (goto-char 9)
+    (should (= (current-column) 18))
+    (goto-char 4)
+    (should (= (current-column) 8))
+    (goto-char 9)
+    (let ((tab-width 4))
+      (should (= (current-column) 10)))
+    (goto-char 8)
+    (should (= (current-column) 17))
+    (put-text-property 1 3 'invisible t)
+    (goto-char 9)
+    (should (= (current-column) 18))
+    (put-text-property 4 6 'display "xyzzyxyzzy")
+    (should (= (current-column) 26))
+    (overlay-put (make-overlay 7 8) 'invisible t)
+    (goto-char 8)
+    (should (= (current-column) 24))
+    (move-to-column 9)
+    (should (= (point) 6))
+    (should (= (current-column) 18))))
+
+(ert-deftest indent-tests-current-column-changed-settings ()
+  "Test `current-column' after changing settings in place."
+  (with-temp-buffer
+    (insert "abcdefgh")
+    (put-text-property 1 3 'invisible 'foo)
+    (put-text-property 4 6 'invisible 'bar)
+    (setq buffer-invisibility-spec (list 'foo 'bar))
+    ;; Each change below must stop the scan to the end of the line
+    ;; from resuming the scan that stopped at 7.
+    (goto-char 7)
+    (should (= (current-column) 2))
+    ;; This changes the list destructively.
+    (remove-from-invisibility-spec 'bar)
+    (should (eq (car buffer-invisibility-spec) 'foo))
+    (goto-char 9)
+    (should (= (current-column) 6))
+    (setq buffer-display-table (make-display-table))
+    (goto-char 7)
+    (should (= (current-column) 4))
+    (aset buffer-display-table ?c (vector ?x ?y ?z))
+    (goto-char 9)
+    (should (= (current-column) 8))
+    (setq buffer-display-table nil)
+    (goto-char 1)
+    (insert "\N{BOX DRAWINGS LIGHT HORIZONTAL}")
+    (let ((char-width-table (copy-sequence char-width-table)))
+      (goto-char 8)
+      (should (= (current-column) 5))
+      (aset char-width-table ?\N{BOX DRAWINGS LIGHT HORIZONTAL} 2)
+      (goto-char 10)
+      (should (= (current-column) 8)))))
+
 ;;; indent-tests.el ends here
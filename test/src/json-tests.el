@@ -223,6 +223,39 @@ json-parse-string/string
   (should-error (json-parse-string "[\"\u00C4\xC3\x84\"]")
                 :type 'json-utf8-decode-error))
 
+;; The string parser scans runs of plain characters a word at a time;
+;; put the interesting bytes at every offset within a word.
+(ert-deftest json-parse-string/string-offsets ()
+  (dolist (special '(("\\n" . "\n") ("\\\"" . "\"") ("é" . "é")
+                     ("\u007f" . "\u007f") ("" . "")))
+    (dotimes (i 20)
+      (let* ((prefix (make-string i ?a))
+             (input (concat "[\"" prefix (car special) "xyz\",\""
+                            prefix "\"]"))
+             (expected (vector (concat prefix (cdr special) "xyz") prefix)))
+        (should (equal (json-parse-string input) expected))
+        (should (equal (json-parse-string (encode-coding-string input 'utf-8))
+                       expected))
+        (should (equal (json-parse-string (concat "{\"" prefix (car special)
+                                                  "\":1}")
+                                          :object-type 'plist)
+                       (list (intern (concat ":" prefix (cdr special))) 1)))
+        ;; Split the input at every position with the buffer gap.
+        (dotimes (j (length input))
+          (with-temp-buffer
+            (insert input)
+            (goto-char (1+ j))
+            (insert "x")
+            (delete-char -1)
+            (goto-char (point-min))
+            (should (equal (json-parse-buffer) expected))))
+        (should-error (json-parse-string (concat "[\"" prefix "\tx\"]"))
+                      :type 'json-parse-error)
+        (should-error (json-parse-string (concat "[\"" prefix "\xFF\"]"))
+                      :type 'json-utf8-decode-error)
+        (should-error (json-parse-string (concat "[\"" prefix))
+                      :type 'json-end-of-file)))))
+
 (ert-deftest json-serialize/string ()
   (should (equal (json-serialize ["foo"]) "[\"foo\"]"))
   (should (equal (json-serialize ["a\n\fb"]) "[\"a\\n\\fb\"]"))
@@ -233,6 +266,34 @@ json-serialize/string
   (should-error (json-serialize ["\xC3\x84"]))
   (should-error (json-serialize ["\u00C4\xC3\x84"])))
 
+(ert-deftest json-serialize/buffer ()
+  (with-temp-buffer
+    (insert "ab\"cd\tαβ")
+    (dotimes (i (1+ (buffer-size)))
+      ;; Move the gap to each position.
+      (goto-char (1+ i))
+      (insert "x")
+      (delete-char -1)
+      (should (equal (json-serialize (vector (current-buffer)))
+                     (encode-coding-string "[\"ab\\\"cd\\tαβ\"]" 'utf-8))))
+    (save-restriction
+      (narrow-to-region 3 6)
+      (should (equal (json-serialize (list :a (current-buffer)))
+                     "{\"a\":\"\\\"cd\"}")))
+    (insert "\xFF")
+    (should-error (json-serialize (current-buffer))
+                  :type 'wrong-type-argument))
+  (with-temp-buffer
+    (set-buffer-multibyte nil)
+    (insert "ab")
+    (should (equal (json-serialize (current-buffer)) "\"ab\""))
+    (insert "\xC3\xA9")
+    (should-error (json-serialize (current-buffer))
+                  :type 'wrong-type-argument))
+  (let ((buffer (generate-new-buffer " *json-test*")))
+    (kill-buffer buffer)
+    (should-error (json-serialize buffer) :type 'wrong-type-argument)))
+
 (ert-deftest json-serialize/invalid-unicode ()
   (should-error (json-serialize ["a\uDBBBb"]) :type 'wrong-type-argument)
   (should-error (json-serialize ["u\x110000v"]) :type 'wrong-type-argument)
@@ -453,5 +514,86 @@ json-parse-error-position
         (goto-char (1+ (length junk)))
         (should (equal (json-tests--parse-buffer-error-pos) 16))))))
 
+;; Every value of a document should be the same as in the fully
+;; parsed value.  Hash tables are not `equal', so compare how they
+;; print.
+(defun json-tests--same-value (a b)
+  (equal (prin1-to-string a) (prin1-to-string b)))
+
+(ert-deftest json-parse-document/get ()
+  (let ((input "{ \"a\" : [1, {\"b\": \"x\\\"y\", \"c\": null}, [], \"s\"],
+ \"é\": [true, false, 1.5], \"k\\n\": {\"\": -3}, \"a\": 7 }"))
+    (dolist (args '(() (:object-type alist) (:object-type plist)
+                    (:array-type list :null-object nil :false-object 0)))
+      (let ((doc (apply #'json-parse-document input args)))
+        (should (json-document-p doc))
+        (should (eq (type-of doc) 'json-document))
+        (should (json-tests--same-value
+                 (json-document-get doc)
+                 (apply #'json-parse-string input args)))
+        (should (json-tests--same-value
+                 (json-document-get (json-document-at doc))
+                 (json-document-get doc)))))
+    (let ((doc (json-parse-document input)))
+      ;; Hash tables keep the last member with a key...
+      (should (equal (json-document-get doc "a") 7))
+      (should-not (json-document-get doc "a" 1))
+      (should (equal (json-document-get doc "é" 2) 1.5))
+      (should (equal (json-document-get doc 'é 1) :false))
+      (should (equal (json-document-get doc "k\n" "") -3))
+      (should (equal (json-document-length doc) 4))
+      (should-not (json-document-get doc "b"))
+      (should-not (json-document-get doc 0))
+      (should-not (json-document-length doc "a"))
+      (should-error (json-document-get doc 1.0) :type 'wrong-type-argument))
+    (let ((doc (json-parse-document input :object-type 'alist)))
+      ;; ...and alists the first one.
+      (should (equal (json-document-get doc 'a 1 'b) "x\"y"))
+      (should (equal (json-document-get doc :a 1 "c") :null))
+      (should (equal (json-document-length doc "a") 4))
+      (should (equal (json-document-length doc "a" 1) 2))
+      (should-not (json-document-length doc "a" 0))
+      (should-not (json-document-get doc "a" 4))
+      (should-not (json-document-get doc "a" -1))
+      (let ((sub (json-document-at doc "a" 1)))
+        (should (json-document-p sub))
+        (should (equal (json-document-get sub "b") "x\"y"))))))
+
+(ert-deftest json-parse-document/elements ()
+  (let ((doc (json-parse-document
+              "[{\"a\": 1, \"b\\u00e9\": [2]}, 3, \"s\", [], {}]")))
+    (should (json-tests--same-value
+             (mapcar #'json-document-get (json-document-elements doc))
+             (append (json-parse-string
+                      "[{\"a\": 1, \"b\\u00e9\": [2]}, 3, \"s\", [], {}]")
+                     nil)))
+    (let ((members (json-document-elements doc 0)))
+      (should (equal (mapcar #'car members) '("a" "bé")))
+      (should (equal (json-document-get (cdr (assoc "bé" members)) 0) 2)))
+    (should-not (json-document-elements doc 1))
+    (should-not (json-document-elements doc 3))
+    (should-not (json-document-elements doc 4))))
+
+(ert-deftest json-parse-document/errors ()
+  (should-error (json-parse-document "") :type 'json-end-of-file)
+  (should-error (json-parse-document "[1,]") :type 'json-parse-error)
+  (should-error (json-parse-document "{\"a\" 1}") :type 'json-parse-error)
+  (should-error (json-parse-document "[1] 2") :type 'json-trailing-content)
+  (should-error (json-parse-document "[\"\xFF\"]")
+                :type 'json-utf8-decode-error)
+  (should-error (json-parse-document "[\"\\uDC00\"]")
+                :type 'json-invalid-surrogate-error)
+  (should-error (json-parse-document (make-string 20000 ?\[))
+                :type 'json-object-too-deep)
+  (condition-case e
+      (json-parse-document "[\"*Ωßœ☃*\",,8]")
+    (json-error (should (equal (nth 3 e) 11))))
+  (should-error (json-document-get "[]") :type 'wrong-type-argument)
+  ;; The document does not change with the string it was parsed from.
+  (let* ((s (copy-sequence "[\"abc\"]"))
+         (doc (json-parse-document s)))
+    (aset s 2 ?é)
+    (should (equal (json-document-get doc 0) "abc"))))
+
 (provide 'json-tests)
 ;;; json-tests.el ends here
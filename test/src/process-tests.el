@@ -108,6 +108,168 @@ process-test-stderr-buffer
 	      (goto-char (point-min))
 	      (looking-at "hello stderr!"))))))
 
+(ert-deftest process-test-default-filter-output ()
+  "Test that the default filter inserts ASCII and non-ASCII output."
+  (skip-unless (executable-find "bash"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (dolist (max '(7 4096))
+      (with-temp-buffer
+        (buffer-disable-undo)
+        (insert "before\n")
+        (let* ((read-process-output-max max)
+               (line "ascii text, h\u00e9llo \u4e2d\u6587\n")
+               (proc (make-process
+                      :name "test" :buffer (current-buffer)
+                      :command (list "bash" "-c"
+                                     (format "for i in {1..50}; do printf '%s'; done"
+                                             (encode-coding-string line 'utf-8)))
+                      :coding 'utf-8-unix :connection-type 'pipe
+                      :sentinel #'ignore)))
+          (set-marker (process-mark proc) (point-min))
+          (while (accept-process-output proc 10))
+          (should (equal (buffer-string)
+                         (concat (apply #'concat (make-list 50 line))
+                                 "before\n")))
+          (should (= (process-mark proc) (- (point-max) 7))))))))
+
+(ert-deftest process-test-default-filter-narrowed ()
+  "Test the default filter when the process mark is outside the narrowing."
+  (skip-unless (executable-find "printf"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (dolist (fast '(nil t))
+      (with-temp-buffer
+        (buffer-disable-undo)
+        (insert "HEADER\nTAIL\n")
+        (let* ((fast-read-process-output fast)
+               (proc (make-process
+                      :name "test" :buffer (current-buffer)
+                      :command '("printf" "out")
+                      :connection-type 'pipe
+                      :sentinel #'ignore)))
+          (narrow-to-region 1 4)
+          (while (accept-process-output proc 10))
+          (widen)
+          ;; The output goes to the end of the accessible portion.
+          (should (equal (buffer-string) "HEAoutDER\nTAIL\n"))
+          (should (= (process-mark proc) 7)))))))
+
+(ert-deftest process-test-output-statistics ()
+  "Test `process-output-statistics'."
+  (skip-unless (executable-find "head"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (let* ((read-process-output-max 4096)
+           (total 0)
+           (calls 0)
+           (proc (make-process
+                  :name "test"
+                  :command '("head" "-c" "1000000" "/dev/zero")
+                  :connection-type 'pipe
+                  :filter (lambda (_proc string)
+                            (setq total (+ total (length string)))
+                            (setq calls (1+ calls)))
+                  :sentinel #'ignore)))
+      (while (accept-process-output proc 10))
+      (let ((stats (process-output-statistics proc)))
+        (should (= total 1000000))
+        (should (= (alist-get 'bytes stats) 1000000))
+        (should (= (alist-get 'reads stats) calls))
+        (should (time-less-p 0 (alist-get 'filter-time stats)))
+        ;; The output arrives faster than it is read, so the read size
+        ;; grows and far fewer than 1000000/4096 reads are needed.
+        (should (< 4096 (alist-get 'read-size stats)))
+        (should (< calls (/ 1000000 4096 2)))))))
+
+(ert-deftest process-test-json-rpc-framing ()
+  "Test `set-process-json-rpc-framing'."
+  (skip-unless (and (executable-find "bash") (executable-find "cat")))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (let* ((file (make-temp-file "process-tests"))
+           (calls nil)
+           (chars (nth 4 (memory-use-counts))))
+      (unwind-protect
+          (let ((coding-system-for-write 'binary))
+            ;; Messages that are read at once go to the filter
+            ;; together, so write them at once, with 'cat'.
+            (write-region
+             (concat "junk\r\n\r\n"
+                     "Content-Length: 16\r\n\r\n{\"a\":1,\"b\":null}"
+                     "Content-Length: 1\r\n\r\n2"
+                     "Content-Length: 3\r\n\r\n{x}"
+                     "Content-Length: 1\r\n\r\n4"
+                     "Content-Length: 12\r\n"
+                     "Content-Type: x\r\n\r\n[\"\xc3\xa9\",")
+             nil file)
+            (let ((proc (make-process
+                         :name "test"
+                         :command
+                         (list "bash" "-c"
+                               (concat
+                                "cat " (shell-quote-argument file) ";"
+                                "sleep 0.1;"
+                                "printf 'false]Content-Length: 1000000000"
+                                "\\r\\n\\r\\n[1'"))
+                         :connection-type 'pipe
+                         :filter (lambda (_proc messages &optional error)
+                                   (push (if error
+                                             (list messages (car error))
+                                           messages)
+                                         calls))
+                         :sentinel #'ignore)))
+              (set-process-json-rpc-framing proc t :object-type 'plist
+                                            :null-object nil)
+              (while (accept-process-output proc 10))))
+        (delete-file file))
+      (should (equal (nreverse calls)
+                     '(((:a 1 :b nil) 2) ("{x}" json-parse-error) (4)
+                       (["é" :false]))))
+      ;; The body that never arrives takes no more memory than what
+      ;; did arrive.
+      (should (< (- (nth 4 (memory-use-counts)) chars) 100000)))))
+
+(ert-deftest process-test-json-send-to-process ()
+  "Test `json-send-to-process'."
+  (skip-unless (executable-find "cat"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (let* ((big (make-string 300000 ?é))
+           (messages nil)
+           (output nil)
+           (framed (make-process
+                    :name "test"
+                    :command '("cat")
+                    :connection-type 'pipe
+                    :filter (lambda (_proc values)
+                              (setq messages (append messages values)))
+                    :sentinel #'ignore))
+           (raw (make-process
+                 :name "test"
+                 :command '("cat")
+                 :connection-type 'pipe
+                 :coding 'binary
+                 :filter (lambda (_proc string) (push string output))
+                 :sentinel #'ignore)))
+      (set-process-json-rpc-framing framed 'text)
+      (with-temp-buffer
+        (insert "a\"b" big)
+        ;; Put the gap in the middle of the text.
+        (goto-char 3)
+        (insert "\n")
+        (narrow-to-region 2 (point-max))
+        (json-send-to-process framed (vector (current-buffer) 1.5) t)
+        (should-not (json-send-to-process raw (vector (current-buffer) :null)
+                                          nil)))
+      (should-error (json-send-to-process framed (vector (make-marker)) t))
+      (should (equal (json-send-to-process framed ["x"] 'text) "[\"x\"]"))
+      (process-send-eof framed)
+      (process-send-eof raw)
+      (while (or (accept-process-output framed 10)
+                 (accept-process-output raw 10)))
+      (should (equal (mapcar #'car messages)
+                     (list (vector (concat "\"\nb" big) 1.5) ["x"])))
+      (should (equal (mapcar #'cdr messages)
+                     (mapcar #'json-serialize (mapcar #'car messages))))
+      (should (equal (apply #'concat (nreverse output))
+                     (json-serialize (vector (concat "\"\nb" big) :null)))))))
+
 (ert-deftest process-test-stderr-filter ()
   (skip-unless (executable-find "bash"))
   (with-timeout (60 (ert-fail "Test timed out"))
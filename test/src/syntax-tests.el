@@ -500,6 +500,27 @@ /*-out
 (syntax-pps-comments /* 56 76 77 58)
 (syntax-pps-comments /* 60 78 79)
 
+;; Backward scans over a comment longer than the interval between
+;; `syntax-ppss' checkpoints parse forward from a checkpoint.
+(ert-deftest syntax-backward-long-comment ()
+  (with-temp-buffer
+    (let ((st (make-syntax-table)))
+      (modify-syntax-entry ?/ ". 124b" st)
+      (modify-syntax-entry ?* ". 23" st)
+      (modify-syntax-entry ?\n "> b" st)
+      (set-syntax-table st))
+    (insert "x = \"/*\"; // */\n/*")
+    (let ((start (- (point) 2)))
+      (dotimes (_ 1000)
+        (insert "a \" long // comment\n"))
+      (insert "*/")
+      (syntax-ppss (point-max))
+      (dolist (use-ppss '(t nil))
+        (let ((comment-use-syntax-ppss use-ppss))
+          (goto-char (point-max))
+          (should (forward-comment -1))
+          (should (= (point) start)))))))
+
 (ert-deftest test-from-to-parse-partial-sexp ()
   (with-temp-buffer
     (insert "foo")
@@ -119,5 +119,45 @@ textprop-interval-immutability
       ;; `inhibit-read-only''s influence towards the end of the buffer.
       (should-error (delete-and-extract-region 26 37)))))
 
+(ert-deftest textprop-tests-put-text-property-runs ()
+  "Test `put-text-property-runs'."
+  (let ((runs '((2 5 bold) (5 7 bold) (9 12 italic) (12 12 underline))))
+    ;; Same result as one `put-text-property' call per run.
+    (let ((string (copy-sequence "abcdefghijklmnop"))
+          (expected (copy-sequence "abcdefghijklmnop")))
+      (put-text-property 0 3 'face 'italic string)
+      (put-text-property 0 3 'face 'italic expected)
+      (dolist (run runs)
+        (put-text-property (nth 0 run) (nth 1 run) 'face (nth 2 run)
+                           expected))
+      (should (eq (put-text-property-runs 'face runs string) t))
+      (should (equal-including-properties string expected))
+      ;; Nothing changes the second time.
+      (should-not (put-text-property-runs 'face runs string)))
+    (with-temp-buffer
+      (insert "abcdefghijklmnop")
+      (let ((calls 0))
+        (add-hook 'after-change-functions
+                  (lambda (beg end _len)
+                    (should (equal (list beg end) '(2 12)))
+                    (setq calls (1+ calls)))
+                  nil t)
+        (should (put-text-property-runs 'face runs))
+        (should (= calls 1))
+        (should (eq (get-text-property 6 'face) 'bold))
+        (should (eq (get-text-property 7 'face) nil))
+        (should (eq (get-text-property 11 'face) 'italic))
+        ;; The two bold runs end up in a single interval, unlike with
+        ;; two `put-text-property' calls.
+        (should (equal (object-intervals (current-buffer))
+                       '((0 1 nil) (1 6 (face bold)) (6 8 nil)
+                         (8 11 (face italic)) (11 16 nil))))
+        (should-not (put-text-property-runs 'face runs))
+        (should (= calls 1))))
+    (should-error (put-text-property-runs 'face '((1 4 bold) (3 5 bold))
+                                          "abcdef"))
+    (should-error (put-text-property-runs 'face '((1 10 bold)) "abcdef")
+                  :type 'args-out-of-range)))
+
 (provide 'textprop-tests)
 ;;; textprop-tests.el ends here
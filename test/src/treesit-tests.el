@@ -194,6 +194,84 @@ treesit-node-api
       (should-error (treesit-node-check root-node 'live)
                     :type 'treesit-node-buffer-killed))))
 
+;;; Tree cursors
+
+(ert-deftest treesit-cursor-api ()
+  "Tests for tree cursors."
+  (skip-unless (treesit-language-available-p 'json))
+  (with-temp-buffer
+    (insert "[1,2,{\"name\": \"Bob\"},3]")
+    (let* ((parser (treesit-parser-create 'json))
+           (root (treesit-parser-root-node parser))
+           (cursor (treesit-node-cursor (treesit-node-child root 0))))
+      (should (treesit-cursor-p cursor))
+      (should-not (treesit-cursor-p root))
+      (should (equal (treesit-cursor-type cursor) "array"))
+      ;; Type strings are shared.
+      (should (eq (treesit-cursor-type cursor) (treesit-cursor-type cursor)))
+      (should (treesit-cursor-goto-child cursor))
+      (should (equal (treesit-cursor-type cursor) "["))
+      (should (treesit-cursor-goto-sibling cursor nil t))
+      (should (equal (treesit-cursor-type cursor) "number"))
+      (should (eql (treesit-cursor-start cursor) 2))
+      (should (eql (treesit-cursor-end cursor) 3))
+      ;; Failing moves leave the cursor alone.
+      (should-not (treesit-cursor-goto-sibling cursor t t))
+      (should (eql (treesit-cursor-start cursor) 2))
+      (should-not (treesit-cursor-goto-child cursor))
+      (should (treesit-cursor-goto-sibling cursor))
+      (should (treesit-cursor-goto-sibling cursor t))
+      (should (eql (treesit-cursor-start cursor) 2))
+      ;; The node is the same as the one the node API returns.
+      (should (treesit-node-eq (treesit-cursor-node cursor)
+                               (treesit-node-child
+                                (treesit-node-child root 0) 0 t)))
+      (should (treesit-cursor-goto-parent cursor))
+      (should (treesit-cursor-goto-child cursor t t))
+      (should (equal (treesit-cursor-type cursor) "number"))
+      (should (eql (treesit-cursor-start cursor) 22))
+      ;; Go up past the node the cursor was made from.
+      (should (treesit-cursor-goto-parent cursor))
+      (should (treesit-cursor-goto-parent cursor))
+      (should (equal (treesit-cursor-type cursor) "document"))
+      (should-not (treesit-cursor-goto-parent cursor))
+      ;; Nodes asked for again are reused until the buffer changes.
+      (should (eq (treesit-node-child root 0) (treesit-node-child root 0)))
+      (goto-char (point-max))
+      (insert " ")
+      (treesit-parser-root-node parser)
+      (should-error (treesit-cursor-type cursor)
+                    :type 'treesit-node-outdated))))
+
+;;; Background parsing
+
+(ert-deftest treesit-parse-in-background ()
+  "Test `treesit-parser-parse-in-background'."
+  (skip-unless (treesit-language-available-p 'json))
+  (with-temp-buffer
+    (let ((parser (treesit-parser-create 'json))
+          (regions nil))
+      (insert "[1,2,3]")
+      ;; Either the parse runs in the background, or Emacs can't do
+      ;; that and the tree comes from a normal parse below.
+      (treesit-parser-parse-in-background parser)
+      (should (equal (treesit-node-string (treesit-parser-root-node parser))
+                     "(document (array (number) (number) (number)))"))
+      (should-not (treesit-parser-parse-in-background parser))
+      ;; Edits made while the background parse runs cancel it.
+      (goto-char (point-max))
+      (insert "[4]")
+      (treesit-parser-parse-in-background parser)
+      (goto-char (point-min))
+      (insert "{\"a\": ")
+      (goto-char (point-max))
+      (insert "}")
+      (setq regions (treesit-parser-changed-regions parser))
+      (should regions)
+      (should (equal (treesit-node-string (treesit-parser-root-node parser))
+                     (treesit-node-string
+                      (treesit-parse-string (buffer-string) 'json)))))))
+
 ;;; Indirect buffer
 
 (ert-deftest treesit-indirect-buffer ()
@@ -590,6 +668,64 @@ treesit-query-api
                (treesit-pattern-expand "a\nb\rc\td\0e\"f\1g\\h\fi")
                "\"a\\nb\\rc\\td\\0e\\\"f\1g\\\\h\fi\"")))))
 
+(ert-deftest treesit-query-equal-predicate ()
+  "Test `:equal' between captures, wherever the buffer gap is."
+  (skip-unless (treesit-language-available-p 'json))
+  (with-temp-buffer
+    (let ((parser (treesit-parser-create 'json))
+          (query (treesit-query-compile
+                  'json '(((pair key: (_) @k value: (_) @v)
+                           (:equal @k @v))))))
+      (insert "{\"ab\": \"ab\", \"cd\": \"ce\", \"é\": \"é\"}")
+      ;; Put the gap inside each captured span in turn.
+      (dolist (pos (number-sequence (point-min) (point-max)))
+        (goto-char pos)
+        (insert " ")
+        (delete-char -1)
+        (should (equal (mapcar (lambda (cap)
+                                 (treesit-node-text (cdr cap) t))
+                               (treesit-query-capture parser query))
+                       '("\"ab\"" "\"ab\"" "\"é\"" "\"é\"")))))))
+
+(defvar treesit--ert-fontified-nodes nil
+  "Nodes passed to `treesit--ert-fontify-node'.")
+
+(defun treesit--ert-fontify-node (node override start end)
+  "Record NODE, OVERRIDE, START and END in `treesit--ert-fontified-nodes'."
+  (push (list (treesit-node-text node t) override start end)
+        treesit--ert-fontified-nodes))
+
+(ert-deftest treesit-query-fontify ()
+  "Test `treesit--query-fontify'."
+  (skip-unless (treesit-language-available-p 'json))
+  (with-temp-buffer
+    (insert "[\"abc\", 1, \"de\", true]")
+    (let ((parser (treesit-parser-create 'json))
+          (query (treesit-query-compile
+                  'json '(((string) @font-lock-string-face
+                           (:match "b" @font-lock-string-face))
+                          (number) @treesit--ert-fontify-node
+                          (true) @not-a-face))))
+      (setq treesit--ert-fontified-nodes nil)
+      ;; Only fontify from the middle of the first string; query the
+      ;; whole buffer.
+      (treesit--query-fontify parser query (point-min) (point-max)
+                              4 (point-max) t)
+      (should (equal (get-text-property 3 'face) nil))
+      (should (equal (get-text-property 4 'face) 'font-lock-string-face))
+      (should (equal (get-text-property 6 'face) 'font-lock-string-face))
+      (should (equal (get-text-property 7 'face) nil))
+      ;; "de" doesn't pass the predicate.
+      (should (equal (get-text-property 13 'face) nil))
+      (should (equal treesit--ert-fontified-nodes
+                     `(("1" t 4 ,(point-max)))))
+      ;; With OVERRIDE nil, existing faces are kept.
+      (put-text-property 4 5 'face 'bold)
+      (treesit--query-fontify parser query (point-min) (point-max)
+                              1 (point-max) nil)
+      (should (equal (get-text-property 2 'face) nil))
+      (should (equal (get-text-property 4 'face) 'bold)))))
+
 ;;; Narrow
 
 (ert-deftest treesit-narrow ()
@@ -52,6 +52,46 @@ xfaces-internal-color-values-from-color-spec
   (should (equal (color-values-from-color-spec "rgbi:0/0x0/0") nil))
   (should (equal (color-values-from-color-spec "rgbi:0/+0x1/0") nil)))
 
+(defun xfaces-tests--merge-cache-entry (prop)
+  "Return the entry for PROP in the face merge cache of the selected frame."
+  (assoc prop (internal--face-merge-cache)))
+
+(ert-deftest xfaces-face-merge-cache ()
+  (make-face 'xfaces-tests--face)
+  (with-temp-buffer
+    (let ((prop (list 'xfaces-tests--face 'italic))
+          (old-buffer (window-buffer)))
+      (unwind-protect
+          (progn
+            (set-window-buffer nil (current-buffer))
+            (insert "abc\n\n" (propertize "def" 'face prop))
+            ;; Faces are freed when the display code next runs, here
+            ;; over text without faces.
+            (clear-face-cache)
+            (window-text-pixel-size nil 1 2)
+            (should-not (internal--face-merge-cache))
+            (window-text-pixel-size nil (point-min) (point-max))
+            (let ((entry (xfaces-tests--merge-cache-entry
+                          '(xfaces-tests--face italic))))
+              (should entry)
+              ;; The cache holds a copy of the property value.
+              (should-not (eq (car entry) prop))
+              ;; A hit leaves the entry as it was; a miss would have
+              ;; stored another copy of the property value.
+              (window-text-pixel-size nil (point-min) (point-max))
+              (should (eq (car (xfaces-tests--merge-cache-entry
+                                '(xfaces-tests--face italic)))
+                          (car entry))))
+            ;; Changing the property value in place makes a new entry.
+            (setcar prop 'bold)
+            (window-text-pixel-size nil (point-min) (point-max))
+            (should (xfaces-tests--merge-cache-entry '(bold italic)))
+            ;; Changing a face definition empties the cache.
+            (set-face-attribute 'xfaces-tests--face nil :underline t)
+            (window-text-pixel-size nil 1 2)
+            (should-not (internal--face-merge-cache)))
+        (set-window-buffer nil old-buffer)))))
+
 (provide 'xfaces-tests)
 
 ;;; xfaces-tests.el ends here